@@ -0,0 +1,77 @@
+#ifndef fluffy_tribble_BENCH_INPUTS_HPP
+#define fluffy_tribble_BENCH_INPUTS_HPP
+
+#include <unistd.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace fluffy_tribble::bench {
+
+/**
+ * Команда с длинным списком аргументов: «echo» и count путей к файлам.
+ * @param count Число аргументов.
+ * @return Командная строка.
+ */
+inline std::string long_argument_line(std::size_t count) {
+    std::string line = "echo";
+    for (std::size_t i = 0; i < count; ++i) {
+        line += " logs/2024/shard_" + std::to_string(i % 64) + "/part-" +
+                std::to_string(i) + ".txt";
+    }
+    return line;
+}
+
+/**
+ * Пайплайн из depth стадий: echo, (depth - 2) раз cat и wc.
+ * @param depth Число стадий (не меньше 2).
+ * @return Командная строка.
+ */
+inline std::string pipeline_line(std::size_t depth) {
+    std::string line = "echo one two three";
+    for (std::size_t i = 2; i < depth; ++i) {
+        line += " | cat";
+    }
+    line += " | wc";
+    return line;
+}
+
+/** Временный текстовый файл заданного размера; удаляется в деструкторе. */
+class TempTextFile {
+public:
+    /**
+     * @param bytes Приблизительный размер файла.
+     */
+    explicit TempTextFile(std::size_t bytes) {
+        char name[] = "/tmp/fluffy_tribble_bench_XXXXXX";
+        const int fd = mkstemp(name);
+        if (fd != -1) {
+            close(fd);
+        }
+        path_ = name;
+        std::ofstream out(path_, std::ios::binary);
+        const std::string line =
+            "2024-05-01T12:00:00Z INFO request handled path=/api/v1/items "
+            "status=200 latency_ms=12\n";
+        for (std::size_t written = 0; written < bytes;
+             written += line.size()) {
+            out << line;
+        }
+    }
+
+    TempTextFile(const TempTextFile &) = delete;
+    TempTextFile &operator=(const TempTextFile &) = delete;
+
+    ~TempTextFile() { std::remove(path_.c_str()); }
+
+    const std::string &path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+}  // namespace fluffy_tribble::bench
+
+#endif  // fluffy_tribble_BENCH_INPUTS_HPP
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""Сквозные замеры исполняемого файла fluffy_tribble.
+
+Сценарии запускают интерпретатор как отдельный процесс и измеряют:
+  * commands/sec — пакетный режим (файл скрипта из N строк);
+  * p50/p99 задержки строки — интерактивный режим через канал: после каждой
+    строки отправляется маркер, и время считается до его появления в выводе;
+  * пиковый RSS интерпретатора: на Linux — VmHWM из /proc/self/status,
+    прочитанный встроенным cat в конце скрипта (ru_maxrss дочернего процесса
+    учитывает память запустившего его Python), иначе — ru_maxrss;
+  * время запуска (`-c exit`).
+
+Результаты можно сохранить в JSON (--save) и сравнить с базовым файлом
+(--baseline): сценарии, ухудшившиеся больше порога, печатаются, код выхода 1.
+"""
+
+import argparse
+import json
+import os
+import select
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+MARKER = "__fluffy_tribble_e2e_done__"
+
+# Метрики, для которых больше — лучше; для остальных лучше меньше.
+HIGHER_IS_BETTER = {"commands_per_sec"}
+
+
+def make_data_file(directory, mib):
+    path = os.path.join(directory, f"data_{mib}m.txt")
+    line = b"2024-05-01T12:00:00Z INFO handled path=/api/items status=200\n"
+    block = line * (1024 * 1024 // len(line))
+    with open(path, "wb") as f:
+        for _ in range(mib):
+            f.write(block)
+    return path
+
+
+def workloads(directory):
+    """Сценарий: имя -> (строки скрипта, число строк для замера задержки)."""
+    data = make_data_file(directory, 64)
+    deep = "echo start" + " | cat" * 30 + " | wc"
+    return {
+        "short_builtins": (["echo hello world", "$X=value", "pwd"] * 700,
+                           600),
+        "big_pipelines": ([f"cat {data} | wc", deep, f"wc {data}"] * 3, 9),
+        "external_heavy": (["true", "ls /", "echo x | tr x y",
+                            "echo a b c | wc | cat"] * 100, 200),
+    }
+
+
+def run_measured(cmd, output=subprocess.DEVNULL):
+    """Запускает процесс; возвращает (секунды, пиковый RSS в КиБ)."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=output,
+                            stderr=subprocess.DEVNULL)
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    if proc.returncode != 0:
+        raise RuntimeError(f"{cmd} exited with {proc.returncode}")
+    rss = usage.ru_maxrss
+    if sys.platform == "darwin":
+        rss //= 1024  # на macOS ru_maxrss в байтах
+    return elapsed, rss
+
+
+def measure_throughput(binary, lines, directory):
+    script = os.path.join(directory, "script.ft")
+    proc_status = os.path.exists("/proc/self/status")
+    with open(script, "w") as f:
+        f.write("\n".join(lines) + "\n")
+        if proc_status:
+            f.write("cat /proc/self/status\n")
+    output = os.path.join(directory, "output.txt")
+    with open(output, "wb") as out:
+        elapsed, rss = run_measured([binary, script], out)
+    if proc_status:
+        with open(output, "rb") as out:
+            for line in out.read().decode(errors="replace").splitlines():
+                if line.startswith("VmHWM:"):
+                    rss = int(line.split()[1])
+    return len(lines) / elapsed, rss
+
+
+def read_until_marker(fd, pending):
+    while MARKER.encode() not in pending:
+        ready, _, _ = select.select([fd], [], [], 30)
+        if not ready:
+            raise RuntimeError("timed out waiting for the interpreter")
+        chunk = os.read(fd, 65536)
+        if not chunk:
+            raise RuntimeError("interpreter exited early")
+        pending += chunk
+    return pending.split(MARKER.encode() + b"\n", 1)[1]
+
+
+def measure_latency(binary, lines):
+    proc = subprocess.Popen([binary], stdin=subprocess.PIPE,
+                            stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL, bufsize=0)
+    fd = proc.stdout.fileno()
+    latencies = []
+    pending = b""
+    for line in lines:
+        start = time.perf_counter()
+        proc.stdin.write(f"{line}\necho {MARKER}\n".encode())
+        pending = read_until_marker(fd, pending)
+        latencies.append(time.perf_counter() - start)
+    proc.stdin.close()
+    proc.wait()
+    latencies.sort()
+    p99 = latencies[min(len(latencies) - 1, int(len(latencies) * 0.99))]
+    return statistics.median(latencies) * 1e3, p99 * 1e3
+
+
+def measure_startup(binary, runs):
+    times = [run_measured([binary, "-c", "exit"])[0] for _ in range(runs)]
+    return statistics.median(times) * 1e3
+
+
+def run_all(binary, selected):
+    results = {}
+    with tempfile.TemporaryDirectory(prefix="fluffy_tribble_e2e_") as tmp:
+        results["startup"] = {"startup_ms": measure_startup(binary, 30)}
+        for name, (lines, latency_lines) in workloads(tmp).items():
+            if selected and name not in selected:
+                continue
+            per_sec, rss = measure_throughput(binary, lines, tmp)
+            p50, p99 = measure_latency(binary, lines[:latency_lines])
+            results[name] = {
+                "commands_per_sec": per_sec,
+                "p50_ms": p50,
+                "p99_ms": p99,
+                "peak_rss_kib": rss,
+            }
+    return results
+
+
+def print_results(results):
+    for name, metrics in results.items():
+        values = ", ".join(f"{k}={v:.3f}" if isinstance(v, float)
+                           else f"{k}={v}" for k, v in metrics.items())
+        print(f"{name:16} {values}")
+
+
+def compare(results, baseline, threshold):
+    """Печатает изменения относительно baseline; True, если нет регрессий."""
+    ok = True
+    for name, metrics in results.items():
+        for key, value in metrics.items():
+            base = baseline.get(name, {}).get(key)
+            if not base:
+                continue
+            change = (value - base) / base
+            worse = -change if key in HIGHER_IS_BETTER else change
+            flag = ""
+            if worse > threshold:
+                flag = "  REGRESSION"
+                ok = False
+            print(f"{name:16} {key:18} {base:12.3f} -> {value:12.3f} "
+                  f"({change:+.1%}){flag}")
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("binary", help="путь к исполняемому fluffy_tribble")
+    parser.add_argument("--workload", action="append",
+                        help="запустить только указанный сценарий")
+    parser.add_argument("--save", help="сохранить результаты в JSON")
+    parser.add_argument("--baseline", help="базовый JSON для сравнения")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="допустимое ухудшение (доля, по умолчанию 0.10)")
+    args = parser.parse_args()
+
+    results = run_all(os.path.abspath(args.binary), args.workload)
+    print_results(results)
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        print()
+        if not compare(results, baseline, args.threshold):
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
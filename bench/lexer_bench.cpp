@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "execution_context.hpp"
+#include "lexer.hpp"
+#include "lexer_scan.hpp"
+#include "line_arena.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+/**
+ * Корпус командных строк: типичные интерактивные команды и длинные
+ * сгенерированные строки (команда компиляции, списки файлов).
+ */
+const std::vector<std::string> &corpus() {
+    static const std::vector<std::string> lines = [] {
+        std::vector<std::string> out = {
+            "ls -la /usr/local/share/doc",
+            "cat /var/log/syslog | grep -i error | wc",
+            "git log --oneline --graph --decorate --all",
+            "echo \"Hello, $USER! Today is $DAY\" | tr a-z A-Z",
+            "$PREFIX=/opt/tools",
+            "find . -name '*.cpp' -newer build/CMakeCache.txt",
+            "docker run --rm -v $PWD:/src -w /src gcc:13 make -j8",
+            "curl -sS -H 'Accept: application/json' https://example.com/api",
+        };
+
+        std::string compile = "/usr/bin/c++ -O2 -g -std=c++23 -fPIC";
+        for (int i = 0; i < 200; ++i) {
+            compile += " -I/home/build/project/third_party/module_" +
+                       std::to_string(i) + "/include";
+            compile += " -DFEATURE_FLAG_" + std::to_string(i) + "=1";
+        }
+        compile += " -c src/interpreter.cpp -o build/interpreter.cpp.o";
+        out.push_back(std::move(compile));
+
+        std::string files = "tar -czf backup.tar.gz";
+        for (int i = 0; i < 2000; ++i) {
+            files += " data/2024/partition_" + std::to_string(i % 37) +
+                     "/events_" + std::to_string(i) + ".jsonl";
+        }
+        out.push_back(std::move(files));
+        return out;
+    }();
+    return lines;
+}
+
+std::size_t corpus_bytes() {
+    std::size_t total = 0;
+    for (const std::string &line : corpus()) {
+        total += line.size();
+    }
+    return total;
+}
+
+void BM_LexerTokenize(benchmark::State &state) {
+    ExecutionContext ctx;
+    ctx.set_env("USER", "builder");
+    Lexer lexer;
+    for (auto _ : state) {
+        for (const std::string &line : corpus()) {
+            benchmark::DoNotOptimize(lexer.tokenize(line, ctx));
+        }
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * corpus_bytes())
+    );
+}
+BENCHMARK(BM_LexerTokenize);
+
+void BM_LexerTokenizeViews(benchmark::State &state) {
+    Lexer lexer;
+    LineArena arena;
+    for (auto _ : state) {
+        for (const std::string &line : corpus()) {
+            benchmark::DoNotOptimize(lexer.tokenize_views(line, arena));
+            arena.release();
+        }
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * corpus_bytes())
+    );
+}
+BENCHMARK(BM_LexerTokenizeViews);
+
+/** Поиск особых байтов по корпусу: векторный путь против побайтового. */
+template <std::size_t (*Scan)(std::string_view, std::size_t)>
+void BM_LexerScan(benchmark::State &state) {
+    for (auto _ : state) {
+        std::size_t specials = 0;
+        for (const std::string &line : corpus()) {
+            for (std::size_t i = Scan(line, 0); i < line.size();
+                 i = Scan(line, i + 1)) {
+                ++specials;
+            }
+        }
+        benchmark::DoNotOptimize(specials);
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * corpus_bytes())
+    );
+}
+BENCHMARK(BM_LexerScan<scan_plain_scalar>)->Name("BM_LexerScan/scalar");
+BENCHMARK(BM_LexerScan<scan_plain>)->Name("BM_LexerScan/simd");
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "bench_inputs.hpp"
+#include "command_manager.hpp"
+#include "command_parser.hpp"
+#include "execution_context.hpp"
+#include "lexer.hpp"
+#include "line_arena.hpp"
+#include "pipe_cache.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+void BM_ParseLongArgs(benchmark::State &state) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    const TokenStream tokens = lexer.tokenize(
+        bench::long_argument_line(static_cast<std::size_t>(state.range(0))),
+        ctx
+    );
+    CommandParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parse(tokens));
+    }
+    state.SetItemsProcessed(
+        static_cast<int64_t>(state.iterations() * tokens.size())
+    );
+}
+BENCHMARK(BM_ParseLongArgs)->ArgName("args")->Range(16, 4096);
+
+void BM_ParseDeepPipeline(benchmark::State &state) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    const TokenStream tokens = lexer.tokenize(
+        bench::pipeline_line(static_cast<std::size_t>(state.range(0))), ctx
+    );
+    CommandParser parser;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parser.parse(tokens));
+    }
+    state.SetItemsProcessed(
+        static_cast<int64_t>(state.iterations() * state.range(0))
+    );
+}
+BENCHMARK(BM_ParseDeepPipeline)->ArgName("stages")->Range(2, 128);
+
+void BM_GetCommandId(benchmark::State &state) {
+    const std::string name = state.range(0) == 0 ? "wc" : "git";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CommandManager::get_command_id(name));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_GetCommandId)->ArgName("external")->Arg(0)->Arg(1);
+
+/** Смесь имён строки скрипта: встроенные в разном регистре и внешние. */
+void BM_GetCommandIdMixed(benchmark::State &state) {
+    const std::string names[] = {"echo", "WC", "grep", "Cat", "sort", "exit"};
+    for (auto _ : state) {
+        for (const std::string &name : names) {
+            benchmark::DoNotOptimize(CommandManager::get_command_id(name));
+        }
+    }
+    state.SetItemsProcessed(
+        static_cast<int64_t>(state.iterations() * std::size(names))
+    );
+}
+BENCHMARK(BM_GetCommandIdMixed);
+
+void BM_LexAndParseLongArgs(benchmark::State &state) {
+    Lexer lexer;
+    CommandParser parser;
+    LineArena arena;
+    const std::string line =
+        bench::long_argument_line(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            parser.parse(lexer.tokenize_views(line, arena))
+        );
+        arena.release();
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * line.size())
+    );
+}
+BENCHMARK(BM_LexAndParseLongArgs)->ArgName("args")->Range(16, 4096);
+
+void BM_PipeCacheHit(benchmark::State &state) {
+    Lexer lexer;
+    CommandParser parser;
+    LineArena arena;
+    const std::string line =
+        bench::long_argument_line(static_cast<std::size_t>(state.range(0)));
+    PipeCache cache;
+    cache.insert(line, parser.parse_list(lexer.tokenize_views(line, arena)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.find(line));
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * line.size())
+    );
+}
+BENCHMARK(BM_PipeCacheHit)->ArgName("args")->Range(16, 4096);
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include "bench_inputs.hpp"
+#include "builtins.hpp"
+#include "command_parser.hpp"
+#include "execution_context.hpp"
+#include "fd_stream.hpp"
+#include "lexer.hpp"
+#include "pipe_executor.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+Pipe parse_line(const std::string &line, ExecutionContext &ctx) {
+    Lexer lexer;
+    CommandParser parser;
+    return parser.parse(lexer.tokenize(line, ctx));
+}
+
+/** Пайплайн из встроенных команд: echo | cat | ... | wc. */
+void BM_PipeBuiltins(benchmark::State &state) {
+    ExecutionContext ctx;
+    const Pipe pipe = parse_line(
+        bench::pipeline_line(static_cast<std::size_t>(state.range(0))), ctx
+    );
+    const auto mode = static_cast<PipeMode>(state.range(1));
+    std::istringstream in;
+    for (auto _ : state) {
+        std::ostringstream out, err;
+        PipeExecutor::execute(pipe, in, out, err, ctx, mode);
+        benchmark::DoNotOptimize(out.str());
+    }
+}
+BENCHMARK(BM_PipeBuiltins)
+    ->ArgNames({"stages", "streaming"})
+    ->ArgsProduct(
+        {{2, 8, 32},
+         {static_cast<int>(PipeMode::SEQUENTIAL),
+          static_cast<int>(PipeMode::STREAMING)}}
+    )
+    ->UseRealTime();
+
+/** Большой файл через пайплайн cat FILE | wc. */
+void BM_PipeCatWcLargeFile(benchmark::State &state) {
+    const auto bytes = static_cast<std::size_t>(state.range(0)) << 20;
+    bench::TempTextFile file(bytes);
+    ExecutionContext ctx;
+    const Pipe pipe = parse_line("cat " + file.path() + " | wc", ctx);
+    std::istringstream in;
+    for (auto _ : state) {
+        std::ostringstream out, err;
+        PipeExecutor::execute(pipe, in, out, err, ctx);
+        benchmark::DoNotOptimize(out.str());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_PipeCatWcLargeFile)
+    ->ArgName("MiB")
+    ->Arg(16)
+    ->Arg(128)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/** cat большого файла в дескриптор (/dev/null): копирование в ядре. */
+void BM_CatLargeFileToFd(benchmark::State &state) {
+    const auto bytes = static_cast<std::size_t>(state.range(0)) << 20;
+    bench::TempTextFile file(bytes);
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream err;
+    FdStreamBuf sink(open("/dev/null", O_WRONLY | O_CLOEXEC));
+    std::ostream out(&sink);
+    for (auto _ : state) {
+        run<CommandID::CAT>({file.path()}, in, out, err, ctx);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_CatLargeFileToFd)
+    ->ArgName("MiB")
+    ->Arg(16)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
+
+/** wc по большому файлу: отображение в память и параллельный подсчёт. */
+void BM_WcLargeFile(benchmark::State &state) {
+    const auto bytes = static_cast<std::size_t>(state.range(0)) << 20;
+    bench::TempTextFile file(bytes);
+    ExecutionContext ctx;
+    std::istringstream in;
+    for (auto _ : state) {
+        std::ostringstream out, err;
+        run<CommandID::WC>({file.path()}, in, out, err, ctx);
+        benchmark::DoNotOptimize(out.str());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_WcLargeFile)
+    ->ArgName("MiB")
+    ->Arg(4)
+    ->Arg(256)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "execution_context.hpp"
+#include "external_runner.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+constexpr const char *kTrue = "/usr/bin/true";
+
+/**
+ * Резидентная куча заданного размера (МиБ): каждая страница затронута, чтобы
+ * fork() был вынужден копировать таблицы страниц.
+ */
+std::vector<char> make_resident_heap(std::size_t mib) {
+    std::vector<char> heap(mib * 1024 * 1024);
+    for (std::size_t i = 0; i < heap.size(); i += 4096) {
+        heap[i] = static_cast<char>(i);
+    }
+    return heap;
+}
+
+/** Прежний способ запуска: fork() + execve() + waitpid(). */
+void BM_ForkExec(benchmark::State &state) {
+    auto heap = make_resident_heap(static_cast<std::size_t>(state.range(0)));
+    benchmark::DoNotOptimize(heap.data());
+    char *argv[] = {const_cast<char *>(kTrue), nullptr};
+    char *envp[] = {nullptr};
+    for (auto _ : state) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execve(kTrue, argv, envp);
+            _exit(127);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+    }
+}
+
+/** Текущий способ: ExternalRunner::run (posix_spawn). */
+void BM_ExternalRunnerSpawn(benchmark::State &state) {
+    auto heap = make_resident_heap(static_cast<std::size_t>(state.range(0)));
+    benchmark::DoNotOptimize(heap.data());
+    ExecutionContext ctx;
+    const std::string name = kTrue;
+    const std::vector<std::string> args;
+    for (auto _ : state) {
+        int status = ExternalRunner::run(
+            name, args, std::cin, std::cout, std::cerr, ctx
+        );
+        benchmark::DoNotOptimize(status);
+    }
+}
+
+BENCHMARK(BM_ForkExec)
+    ->ArgName("heap_mib")
+    ->Arg(0)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ExternalRunnerSpawn)
+    ->ArgName("heap_mib")
+    ->Arg(0)
+    ->Arg(256)
+    ->Arg(1024)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace fluffy_tribble
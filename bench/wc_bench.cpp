@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include "wc_counter.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+constexpr std::size_t kTextSize = 64 * 1024 * 1024;
+
+/** Текст из слов случайной длины, разделённых пробелами и переводами строк. */
+const std::string &sample_text() {
+    static const std::string text = [] {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> word_len(1, 12);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> sep(0, 9);
+        std::string out;
+        out.reserve(kTextSize);
+        while (out.size() < kTextSize) {
+            for (int i = word_len(gen); i > 0; --i) {
+                out += static_cast<char>(letter(gen));
+            }
+            out += sep(gen) == 0 ? '\n' : ' ';
+        }
+        return out;
+    }();
+    return text;
+}
+
+/** Прежняя реализация wc: istringstream на каждую строку. */
+void BM_WcLineStream(benchmark::State &state) {
+    const std::string &text = sample_text();
+    for (auto _ : state) {
+        std::istringstream in(text);
+        std::size_t lines = 0, words = 0, bytes = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            ++lines;
+            bytes += line.size() + 1;
+            std::istringstream iss(line);
+            std::string w;
+            while (iss >> w) {
+                ++words;
+            }
+        }
+        benchmark::DoNotOptimize(lines + words + bytes);
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * text.size())
+    );
+}
+BENCHMARK(BM_WcLineStream)->Unit(benchmark::kMillisecond);
+
+void BM_WcCounter(benchmark::State &state) {
+    const auto kernel = static_cast<WcKernel>(state.range(0));
+    if (!WcCounter::kernel_supported(kernel)) {
+        state.SkipWithError("kernel is not supported by this CPU");
+        return;
+    }
+    const std::string &text = sample_text();
+    for (auto _ : state) {
+        WcCounter counter(kernel);
+        counter.feed(text);
+        benchmark::DoNotOptimize(counter.counts());
+    }
+    state.SetBytesProcessed(
+        static_cast<int64_t>(state.iterations() * text.size())
+    );
+}
+BENCHMARK(BM_WcCounter)
+    ->ArgName("kernel")
+    ->Arg(static_cast<int>(WcKernel::SCALAR))
+    ->Arg(static_cast<int>(WcKernel::SSE2))
+    ->Arg(static_cast<int>(WcKernel::AVX2))
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace fluffy_tribble
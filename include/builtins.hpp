@@ -16,15 +16,16 @@ using WriterT = std::ostream;
 
 /**
  * Реализация команды по тегу CommandID.
- * Специализации: CAT, ECHO, WC, PWD, EXIT.
+ * Специализации: CAT, ECHO, WC, PWD, HASH, ENABLE, JOBS, EXIT.
  * @param args Аргументы команды.
  * @param input Входной поток (для cat/wc при чтении из stdin).
  * @param output Выходной поток.
  * @param err Поток ошибок.
  * @param ctx Контекст выполнения.
+ * @return Код возврата команды (0 при успехе).
  */
 template <CommandID Id>
-void run(
+int run(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -32,9 +33,12 @@ void run(
     ExecutionContext &ctx
 );
 
-/** Специализация: cat — выводит содержимое файла или stdin. */
+/**
+ * Специализация: cat — выводит содержимое файла или stdin; 1, если файл не
+ * удалось открыть или прочитать.
+ */
 template <>
-void run<CommandID::CAT>(
+int run<CommandID::CAT>(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -44,7 +48,7 @@ void run<CommandID::CAT>(
 
 /** Специализация: echo — выводит аргументы через пробел и перевод строки. */
 template <>
-void run<CommandID::ECHO>(
+int run<CommandID::ECHO>(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -52,9 +56,12 @@ void run<CommandID::ECHO>(
     ExecutionContext &ctx
 );
 
-/** Специализация: wc — строки, слова, байты в файле или stdin. */
+/**
+ * Специализация: wc — строки, слова, байты в каждом файле (и итог, если
+ * файлов несколько) или в stdin; 1, если хотя бы один файл не прочитан.
+ */
 template <>
-void run<CommandID::WC>(
+int run<CommandID::WC>(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -64,7 +71,83 @@ void run<CommandID::WC>(
 
 /** Специализация: pwd — текущая рабочая директория. */
 template <>
-void run<CommandID::PWD>(
+int run<CommandID::PWD>(
+    const std::vector<std::string> &args,
+    ReaderT &input,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+);
+
+/**
+ * Специализация: hash — кэш путей к внешним программам.
+ * Без аргументов выводит кэш, hash -r очищает его, hash NAME... ищет программы
+ * по PATH и запоминает их. 1, если программа не найдена; 2 при неизвестном
+ * параметре.
+ */
+template <>
+int run<CommandID::HASH>(
+    const std::vector<std::string> &args,
+    ReaderT &input,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+);
+
+/**
+ * Специализация: enable -f FILE NAME... — загружает команды NAME из
+ * разделяемой библиотеки FILE (см. plugin_api.h). 1, если загрузить
+ * удалось не все команды; 2 при ошибке параметров.
+ */
+template <>
+int run<CommandID::ENABLE>(
+    const std::vector<std::string> &args,
+    ReaderT &input,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+);
+
+/**
+ * Специализация: jobs — фоновые задания и их состояние; о завершённых
+ * сообщается один раз.
+ */
+template <>
+int run<CommandID::JOBS>(
+    const std::vector<std::string> &args,
+    ReaderT &input,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+);
+
+/**
+ * wait [ID...] — дожидается фоновых заданий ID (номер или %номер), без
+ * аргументов — всех.
+ * @param args Номера заданий.
+ * @param err Поток ошибок.
+ * @param ctx Контекст выполнения (таблица заданий).
+ * @return Код возврата последнего задания из args; 127, если такого
+ * задания нет; 0 без аргументов.
+ */
+int wait_jobs(
+    const std::vector<std::string> &args,
+    WriterT &err,
+    ExecutionContext &ctx
+);
+
+/**
+ * parallel [-j N] [-k] COMMAND [ARG...] — выполняет COMMAND для каждой
+ * строки входа на N исполнителях (см. ParallelRunner). -P N — то же, что
+ * -j N; -k — вывод в порядке строк входа.
+ * @param args Параметры и шаблон команды.
+ * @param input Строки входа.
+ * @param output Выходной поток.
+ * @param err Поток ошибок.
+ * @param ctx Контекст выполнения.
+ * @return Число неудачных команд (не больше 101); 2 при ошибке параметров.
+ */
+int run_parallel(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -72,9 +155,12 @@ void run<CommandID::PWD>(
     ExecutionContext &ctx
 );
 
-/** Специализация: exit — устанавливает флаг выхода и код. */
+/**
+ * Специализация: exit [N] — устанавливает флаг выхода и код. Нечисловой N —
+ * выход с кодом 2; больше одного аргумента — ошибка (1) без выхода.
+ */
 template <>
-void run<CommandID::EXIT>(
+int run<CommandID::EXIT>(
     const std::vector<std::string> &args,
     ReaderT &input,
     WriterT &output,
@@ -0,0 +1,116 @@
+#ifndef fluffy_tribble_CHROME_TRACE_HPP
+#define fluffy_tribble_CHROME_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+namespace fluffy_tribble {
+
+/** Переменная окружения: путь к файлу трассировки в формате Chrome. */
+inline constexpr const char *kChromeTraceEnv = "FLUFFY_CHROME_TRACE";
+
+/**
+ * Запись событий в формате Chrome trace_event (JSON-массив событий «X» с
+ * pid/tid), который открывается в chrome://tracing и Perfetto. События
+ * пишутся в файл по мере завершения; у каждого потока интерпретатора свой
+ * tid, поэтому одновременные стадии пайплайна видны на отдельных дорожках.
+ * Пока запись не включена, замеры сводятся к проверке одного флага.
+ */
+class ChromeTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Включает запись в файл (перезаписывая его). Уже включённая запись
+     * предварительно завершается.
+     * @param path Путь к файлу.
+     * @return false, если файл не удалось открыть.
+     */
+    static bool start(const std::string &path);
+
+    /** Завершает запись и закрывает файл. */
+    static void stop();
+
+    /**
+     * @return true, если запись включена.
+     */
+    static bool enabled() noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Записывает завершённый интервал.
+     * @param category Категория события.
+     * @param name Имя события.
+     * @param begin Начало интервала.
+     * @param end Конец интервала.
+     * @param detail Подробность (аргумент события), может быть пустой.
+     */
+    static void complete(
+        const char *category,
+        const char *name,
+        Clock::time_point begin,
+        Clock::time_point end,
+        std::string_view detail
+    );
+
+private:
+    static inline std::atomic<bool> enabled_{false};
+};
+
+/**
+ * Интервал трассировки от создания до разрушения объекта. Текст detail
+ * должен быть жив до конца интервала.
+ */
+class TraceScope {
+public:
+    /**
+     * @param category Категория события.
+     * @param name Имя события.
+     * @param detail Подробность (например, имя команды).
+     */
+    TraceScope(
+        const char *category,
+        const char *name,
+        std::string_view detail = {}
+    ) noexcept
+        : category_(category),
+          name_(name),
+          detail_(detail),
+          active_(ChromeTrace::enabled()) {
+        if (active_) {
+            begin_ = ChromeTrace::Clock::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (active_) {
+            ChromeTrace::complete(
+                category_, name_, begin_, ChromeTrace::Clock::now(), detail_
+            );
+        }
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *category_;
+    const char *name_;
+    std::string_view detail_;
+    bool active_;
+    ChromeTrace::Clock::time_point begin_;
+};
+
+/**
+ * Экранирует строку для JSON.
+ * @param s Строка.
+ * @return Экранированная строка (без кавычек).
+ */
+std::string json_escape(std::string_view s);
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_CHROME_TRACE_HPP
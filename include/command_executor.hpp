@@ -4,6 +4,7 @@
 #include <iosfwd>
 #include "execution_context.hpp"
 #include "parsed_command.hpp"
+#include "stage_stats.hpp"
 
 namespace fluffy_tribble {
 
@@ -20,14 +21,45 @@ public:
      * @param output Выходной поток.
      * @param error Поток ошибок.
      * @param ctx Контекст (окружение, exit-флаг и т.д.).
+     * @param stats Если задан, в него записываются замеры команды.
      */
     static void execute(
         const ParsedCommand &cmd,
         std::istream &input,
         std::ostream &output,
         std::ostream &error,
-        ExecutionContext &ctx
+        ExecutionContext &ctx,
+        StageStats *stats = nullptr
     );
+
+    /**
+     * Выполняет одну команду и возвращает её код возврата, не записывая его в
+     * ctx. Используется стадиями пайплайна, работающими одновременно.
+     * @param cmd Разобранная команда (имя, аргументы, id).
+     * @param input Входной поток.
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     * @param ctx Контекст выполнения.
+     * @param stats Если задан, в него записываются замеры команды: время по
+     * часам, процессорное время (для внешних — по wait4), байты на входе и
+     * выходе.
+     * @return Код возврата команды (для встроенных — 0).
+     */
+    static int run(
+        const ParsedCommand &cmd,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        StageStats *stats = nullptr
+    );
+
+    /**
+     * Снимает префикс time: команда из его аргументов.
+     * @param cmd Команда с id TIME и непустыми аргументами.
+     * @return Команда, которую нужно замерить.
+     */
+    static ParsedCommand strip_time(const ParsedCommand &cmd);
 };
 
 }  // namespace fluffy_tribble
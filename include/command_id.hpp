@@ -16,6 +16,20 @@ enum class CommandID {
     WC,
     /** Встроенная команда pwd. */
     PWD,
+    /** Встроенная команда hash (кэш путей к программам). */
+    HASH,
+    /** Префикс time: замер времени и ресурсов стадий пайплайна. */
+    TIME,
+    /** Встроенная команда enable (загрузка команд из библиотек). */
+    ENABLE,
+    /** Встроенная команда jobs (список фоновых заданий). */
+    JOBS,
+    /** Встроенная команда wait (ожидание фоновых заданий). */
+    WAIT,
+    /** Встроенная команда parallel (шаблон команды по строкам входа). */
+    PARALLEL,
+    /** Команда, зарегистрированная во время работы (register_builtin). */
+    PLUGIN,
     /** Присваивание переменной окружения ($name=value). */
     ASSIGN,
     /** Команда выхода из интерпретатора. */
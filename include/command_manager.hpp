@@ -1,8 +1,12 @@
 #ifndef fluffy_tribble_COMMAND_MANAGER_HPP
 #define fluffy_tribble_COMMAND_MANAGER_HPP
 
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "command_id.hpp"
 
@@ -13,9 +17,10 @@ class ExecutionContext;
 class CommandManager {
 public:
     /**
-     * Тип указателя на реализацию команды (run<CommandID>).
+     * Тип указателя на реализацию команды (run<CommandID>); возвращает код
+     * возврата команды.
      */
-    using CommandFn = void (*)(
+    using CommandFn = int (*)(
         const std::vector<std::string> &args,
         std::istream &input,
         std::ostream &output,
@@ -24,18 +29,60 @@ public:
     );
 
     /**
-     * Возвращает тег команды по имени.
+     * Реализация команды, зарегистрированной во время работы: любой
+     * вызываемый объект. Выполняется в процессе интерпретатора, как
+     * встроенные команды (в пайплайне — в потоке своей стадии).
+     * @return Код возврата команды.
+     */
+    using BuiltinFn = std::function<int(
+        const std::vector<std::string> &args,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &err,
+        ExecutionContext &ctx
+    )>;
+
+    /**
+     * Возвращает тег команды по имени (без учёта регистра ASCII, без
+     * выделения памяти). Встроенные команды ищутся в таблице с совершенным
+     * хешем, построенной при компиляции; зарегистрированные — в карте с
+     * поиском по string_view.
      * @param name Имя команды.
      * @return Зарегистрированный CommandID или EXTERNAL, если имя не найдено.
      */
-    static CommandID get_command_id(const std::string &name);
+    static CommandID get_command_id(std::string_view name);
 
     /**
-     * Регистрирует имя команды для данного тега (runtime).
+     * Регистрирует имя команды для данного тега (runtime). Зарегистрированное
+     * имя имеет приоритет над встроенным.
      * @param name Имя команды.
      * @param id Тег (CAT, ECHO, WC, PWD, EXIT и т.д.).
      */
-    static void register_command(const std::string &name, CommandID id);
+    static void register_command(std::string_view name, CommandID id);
+
+    /**
+     * Регистрирует команду с собственной реализацией (тег PLUGIN). Повторная
+     * регистрация имени заменяет реализацию; уже запущенные команды
+     * продолжают выполнять прежнюю.
+     * @param name Имя команды.
+     * @param fn Реализация.
+     */
+    static void register_builtin(std::string_view name, BuiltinFn fn);
+
+    /**
+     * Возвращает реализацию зарегистрированной команды.
+     * @param name Имя команды.
+     * @return Реализация или nullptr, если имя не зарегистрировано через
+     * register_builtin.
+     */
+    static std::shared_ptr<const BuiltinFn> get_builtin(std::string_view name);
+
+    /**
+     * Поколение таблицы имён: увеличивается при каждой регистрации. Разбор
+     * строки, выполненный при другом поколении, мог определить теги иначе.
+     * @return Текущее поколение.
+     */
+    static std::uint64_t generation();
 
     /**
      * Возвращает указатель на реализацию команды по тегу.
@@ -1,6 +1,7 @@
 #ifndef fluffy_tribble_COMMAND_PARSER_HPP
 #define fluffy_tribble_COMMAND_PARSER_HPP
 
+#include <string>
 #include <vector>
 #include "parsed_command.hpp"
 #include "token.hpp"
@@ -10,9 +11,22 @@ namespace fluffy_tribble {
 /**
  * Преобразует поток токенов в пайплайн команд (набор ParsedCommand).
  * Присваивание ($name=value) трактуется как отдельная команда с id ASSIGN.
+ * Перенаправления (< FILE, > FILE, >> FILE, 2> FILE, 2>> FILE) собираются в
+ * ParsedCommand::redirects своей команды; без имени файла или без команды
+ * бросается std::runtime_error. Операторы списка (;, &, &&, ||) разбирает
+ * только parse_list. Подстановки из токенов-представлений не выполняются, а
+ * переносятся в ParsedCommand::words и Redirect::expansions (см. Expander).
  */
 class CommandParser {
 public:
+    /**
+     * Собирает команду из слов: первое — имя, по нему определяется тип; у
+     * внешней команды имя остаётся и первым аргументом.
+     * @param words Непустой список слов.
+     * @return Команда.
+     */
+    static ParsedCommand make_command(std::vector<std::string> words);
+
     /**
      * Разбирает поток токенов в пайплайн.
      * Пайпы (|) в этой части не обрабатываются — все слова до EOF образуют одну
@@ -21,6 +35,31 @@ public:
      * @return Пайплайн (вектор команд; без пайпов — одна команда).
      */
     Pipe parse(const TokenStream &tokens);
+
+    /**
+     * Разбирает поток токенов-представлений в пайплайн. Команды владеют
+     * своими строками, поэтому токены и их арену можно освободить сразу
+     * после разбора.
+     * @param tokens Результат Lexer::tokenize_views.
+     * @return Пайплайн.
+     */
+    Pipe parse(const TokenViewStream &tokens);
+
+    /**
+     * Разбирает поток токенов в список команд: пайплайны, разделённые ;, &,
+     * && и ||. Оператор без пайплайна перед ним, а также && или || в конце
+     * — ошибка (std::runtime_error); ; и & в конце допустимы.
+     * @param tokens Результат работы лексера (должен заканчиваться EOF_).
+     * @return Список команд (пустой для пустой строки).
+     */
+    CommandList parse_list(const TokenStream &tokens);
+
+    /**
+     * Разбирает поток токенов-представлений в список команд.
+     * @param tokens Результат Lexer::tokenize_views.
+     * @return Список команд.
+     */
+    CommandList parse_list(const TokenViewStream &tokens);
 };
 
 }  // namespace fluffy_tribble
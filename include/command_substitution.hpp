@@ -0,0 +1,50 @@
+#ifndef fluffy_tribble_COMMAND_SUBSTITUTION_HPP
+#define fluffy_tribble_COMMAND_SUBSTITUTION_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * Подстановка вывода команд $(...). Текст внутри скобок выполняется как
+ * список команд в том же процессе, с копией контекста (как в подоболочке:
+ * присваивания и exit в нём не влияют на исходный контекст) и с пустым
+ * вводом. Вывод собирается в строку; встроенные команды пишут в неё
+ * напрямую, процессы запускаются только для внешних команд. Подстановку
+ * выполняет Expander перед запуском пайплайна, в котором она записана.
+ */
+class CommandSubstitution {
+public:
+    /**
+     * Ищет скобку, закрывающую подстановку. Скобки внутри кавычек и
+     * экранированные скобки не учитываются, вложенные подстановки
+     * пропускаются целиком.
+     * @param input Строка.
+     * @param begin Позиция сразу после открывающей скобки.
+     * @return Позиция закрывающей скобки или npos.
+     */
+    static std::size_t find_end(std::string_view input, std::size_t begin);
+
+    /**
+     * Выполняет команды и возвращает их вывод без завершающих переводов
+     * строки. Фоновые задания, запущенные внутри, дожидаются завершения.
+     * @param commands Текст внутри $( ).
+     * @param ctx Контекст, с которого снимается копия.
+     * @param error Поток ошибок команд.
+     * @return Вывод команд.
+     * @throw std::runtime_error Ошибка разбора команд.
+     */
+    static std::string run(
+        std::string_view commands,
+        const ExecutionContext &ctx,
+        std::ostream &error
+    );
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_COMMAND_SUBSTITUTION_HPP
@@ -1,8 +1,16 @@
 #ifndef fluffy_tribble_EXECUTION_CONTEXT_HPP
 #define fluffy_tribble_EXECUTION_CONTEXT_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <string_view>
+#include <vector>
+#include "job_table.hpp"
+#include "path_cache.hpp"
 
 namespace fluffy_tribble {
 
@@ -15,19 +23,63 @@ public:
     /** Отображение имя переменной окружения → значение. */
     using EnvMap = std::unordered_map<std::string, std::string>;
 
+    /**
+     * Переменная с номером последнего фонового задания ($!). Внешним
+     * программам не передаётся.
+     */
+    static constexpr std::string_view kLastJobVar = "!";
+
+    /**
+     * Готовый к передаче в execve/posix_spawn массив envp ("имя=значение",
+     * завершается nullptr). Неизменяем: держатель копии может пользоваться им
+     * и после изменения окружения.
+     */
+    class EnvBlock {
+    public:
+        /**
+         * Строит массив по отображению переменных окружения.
+         * @param env Переменные окружения.
+         * @param version Версия окружения, по которой построен массив.
+         */
+        EnvBlock(const EnvMap &env, std::uint64_t version);
+
+        EnvBlock(const EnvBlock &) = delete;
+        EnvBlock &operator=(const EnvBlock &) = delete;
+
+        /**
+         * @return Массив envp, завершённый nullptr.
+         */
+        char *const *envp() const;
+
+        /**
+         * @return Версия окружения, по которой построен массив.
+         */
+        std::uint64_t version() const;
+
+    private:
+        std::string storage_;
+        std::vector<char *> pointers_;
+        std::uint64_t version_;
+    };
+
     /**
      * Создаёт контекст и инициализирует окружение из процесса (environ).
      */
     ExecutionContext();
 
     /**
-     * Возвращает изменяемую ссылку на переменные окружения.
-     * @return Ссылка на отображение переменных окружения (имя -> значение).
+     * Копия для фонового задания (как подоболочка): окружение и текущая
+     * директория. Задания, кэш путей, код возврата и флаг выхода не
+     * копируются.
+     * @param parent Контекст, из которого запускается задание.
      */
-    EnvMap &env();
+    ExecutionContext(const ExecutionContext &parent);
+
+    ExecutionContext &operator=(const ExecutionContext &) = delete;
 
     /**
-     * Возвращает константную ссылку на переменные окружения.
+     * Возвращает константную ссылку на переменные окружения. Изменяется
+     * окружение только через set_env и unset_env.
      * @return Константная ссылка на отображение переменных окружения (имя ->
      * значение).
      */
@@ -35,11 +87,45 @@ public:
 
     /**
      * Устанавливает переменную окружения name в value.
+     * Изменение PATH сбрасывает кэш путей к программам.
      * @param name Имя переменной окружения.
      * @param value Значение переменной окружения.
      */
     void set_env(const std::string &name, const std::string &value);
 
+    /**
+     * Удаляет переменную окружения name, если она задана.
+     * @param name Имя переменной окружения.
+     */
+    void unset_env(const std::string &name);
+
+    /**
+     * Версия окружения: увеличивается при каждом его изменении. Может
+     * читаться из любого потока.
+     * @return Текущая версия окружения.
+     */
+    std::uint64_t env_version() const;
+
+    /**
+     * Возвращает массив envp для запуска внешних программ. Массив строится
+     * только после изменения окружения, иначе возвращается закэшированный.
+     * Потокобезопасен относительно других вызовов env_block().
+     * @return Массив envp текущей версии окружения.
+     */
+    std::shared_ptr<const EnvBlock> env_block();
+
+    /**
+     * Возвращает кэш путей к внешним программам (команда hash).
+     * @return Ссылка на кэш путей.
+     */
+    PathCache &path_cache();
+
+    /**
+     * Возвращает таблицу фоновых заданий.
+     * @return Ссылка на таблицу заданий.
+     */
+    JobTable &jobs();
+
     /**
      * Возвращает текущую рабочую директорию.
      * @return Путь к текущей рабочей директории.
@@ -91,10 +177,16 @@ public:
 
 private:
     EnvMap env_;
+    std::atomic<std::uint64_t> env_version_ = 0;
+    std::shared_ptr<const EnvBlock> env_block_;
+    std::mutex env_block_mutex_;
+    PathCache path_cache_;
     std::string cwd_;
     bool is_exit_ = false;
     int last_status_ = 0;
     int exit_code_ = 0;
+    /** Последним членом: задания дожидаются до разрушения остального. */
+    JobTable jobs_;
 };
 
 }  // namespace fluffy_tribble
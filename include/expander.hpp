@@ -0,0 +1,72 @@
+#ifndef fluffy_tribble_EXPANDER_HPP
+#define fluffy_tribble_EXPANDER_HPP
+
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include "execution_context.hpp"
+#include "parsed_command.hpp"
+#include "word.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * Подстановки в словах разобранного пайплайна: $NAME и $! — значения
+ * переменных, $(...) — вывод команд (CommandSubstitution). ListExecutor
+ * вызывает их перед запуском каждого пайплайна списка, поэтому в
+ * "$x=1; echo $x" второй пайплайн видит новое значение, а пропущенный
+ * после && или || пайплайн ничего не выполняет.
+ */
+class Expander {
+public:
+    /**
+     * @param pipe Пайплайн.
+     * @return Есть ли в пайплайне невыполненные подстановки.
+     */
+    static bool needs_expansion(const Pipe &pipe);
+
+    /**
+     * Текст слова с подставленными значениями. Не заданная переменная
+     * подставляется пустой строкой.
+     * @param text Текст слова без подстановок.
+     * @param expansions Подстановки по возрастанию позиции.
+     * @param ctx Контекст (значения переменных).
+     * @param error Поток ошибок команд $(...).
+     * @return Текст слова.
+     * @throw std::runtime_error Ошибка разбора команд в $( ).
+     */
+    static std::string expand(
+        std::string_view text,
+        std::span<const Expansion> expansions,
+        const ExecutionContext &ctx,
+        std::ostream &error
+    );
+
+    /**
+     * Пайплайн с выполненными подстановками. Слова, ставшие пустыми,
+     * отбрасываются, как пустые слова при разборе; команда без слов
+     * пропускается. Имя и тип команды определяются по новому тексту.
+     * @param pipe Пайплайн.
+     * @param ctx Контекст (значения переменных).
+     * @param error Поток ошибок команд $(...).
+     * @return Пайплайн без подстановок.
+     * @throw std::runtime_error Ошибка разбора команд в $( ).
+     */
+    static Pipe expand(
+        const Pipe &pipe,
+        const ExecutionContext &ctx,
+        std::ostream &error
+    );
+
+    /**
+     * Запись слова в исходной строке: $NAME, $! и $(...) на своих местах.
+     * @param word Слово.
+     * @return Текст.
+     */
+    static std::string source(const Word &word);
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_EXPANDER_HPP
@@ -2,9 +2,12 @@
 #define fluffy_tribble_EXTERNAL_RUNNER_HPP
 
 #include <iosfwd>
+#include <span>
 #include <string>
 #include <vector>
 #include "execution_context.hpp"
+#include "parsed_command.hpp"
+#include "stage_stats.hpp"
 
 namespace fluffy_tribble {
 
@@ -22,6 +25,7 @@ public:
      * @param output Выходной поток.
      * @param error Поток ошибок.
      * @param ctx Контекст (окружение берётся из ctx.env()).
+     * @param usage Если задан, к нему добавляется процессорное время процесса.
      * @return Код возврата процесса.
      */
     static int run(
@@ -30,10 +34,32 @@ public:
         std::istream &input,
         std::ostream &output,
         std::ostream &error,
-        ExecutionContext &ctx
+        ExecutionContext &ctx,
+        ChildUsage *usage = nullptr
+    );
+
+    /**
+     * Запускает цепочку внешних программ, соединённых каналами pipe(2):
+     * stdout каждой программы напрямую подключается к stdin следующей, данные
+     * между ними не проходят через интерпретатор.
+     * @param cmds Подряд идущие внешние команды пайплайна (id EXTERNAL).
+     * @param input Входной поток первой программы.
+     * @param output Выходной поток последней программы.
+     * @param error Общий поток ошибок.
+     * @param ctx Контекст (окружение берётся из ctx.env()).
+     * @param usage Если задан, к нему добавляется процессорное время программ.
+     * @return Код возврата последней программы.
+     */
+    static int run_chain(
+        std::span<const ParsedCommand> cmds,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        ChildUsage *usage = nullptr
     );
 };
 
 }  // namespace fluffy_tribble
 
-#endif  // fluffy_tribble_EXTERNAL_RUNNER_HPP
\ No newline at end of file
+#endif  // fluffy_tribble_EXTERNAL_RUNNER_HPP
@@ -0,0 +1,78 @@
+#ifndef fluffy_tribble_FD_STREAM_HPP
+#define fluffy_tribble_FD_STREAM_HPP
+
+#include <cstddef>
+#include <ios>
+#include <streambuf>
+#include <vector>
+
+namespace fluffy_tribble {
+
+/**
+ * Буфер потока поверх файлового дескриптора (канал, файл). Позволяет
+ * встроенным командам работать с дескриптором через istream/ostream, а
+ * ExternalRunner и cat — узнать дескриптор и передать его программе или ядру
+ * напрямую. Один буфер используется либо для чтения, либо для записи.
+ */
+class FdStreamBuf : public std::streambuf {
+public:
+    /** Размер буфера по умолчанию (в байтах). */
+    static constexpr std::size_t kDefaultBufferSize = 64 * 1024;
+
+    /**
+     * @param fd Файловый дескриптор.
+     * @param owns Закрывать ли дескриптор в деструкторе.
+     * @param buffer_size Размер буфера чтения/записи.
+     */
+    explicit FdStreamBuf(
+        int fd,
+        bool owns = true,
+        std::size_t buffer_size = kDefaultBufferSize
+    );
+
+    FdStreamBuf(const FdStreamBuf &) = delete;
+    FdStreamBuf &operator=(const FdStreamBuf &) = delete;
+
+    /** Сбрасывает буфер записи и закрывает дескриптор, если владеет им. */
+    ~FdStreamBuf() override;
+
+    /**
+     * @return Файловый дескриптор.
+     */
+    int fd() const;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+    int_type underflow() override;
+
+private:
+    bool flush_buffer();
+
+    int fd_;
+    bool owns_;
+    std::vector<char> buffer_;
+};
+
+/**
+ * Возвращает файловый дескриптор, стоящий за потоком: 0/1/2 для
+ * std::cin/std::cout/std::cerr или дескриптор FdStreamBuf.
+ * @param stream Поток.
+ * @return Дескриптор или -1, если поток не связан с дескриптором.
+ */
+int stream_fd(const std::ios &stream);
+
+/**
+ * Копирует всё содержимое in_fd (с текущей позиции) в out_fd средствами ядра,
+ * когда это возможно (copy_file_range, sendfile, splice), иначе — чтением и
+ * записью большими блоками.
+ * @param in_fd Источник.
+ * @param out_fd Приёмник.
+ * @return true при успехе, false при ошибке чтения или записи.
+ */
+bool copy_fd(int in_fd, int out_fd);
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_FD_STREAM_HPP
@@ -0,0 +1,115 @@
+#ifndef fluffy_tribble_INTERPRETER_HPP
+#define fluffy_tribble_INTERPRETER_HPP
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "execution_context.hpp"
+#include "line_arena.hpp"
+#include "parsed_command.hpp"
+#include "pipe_cache.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * Цикл интерпретатора: строка → Lexer → CommandParser → ListExecutor.
+ * Разобранные строки кэшируются (PipeCache): повторная строка сразу
+ * передаётся на выполнение. Подстановки $VAR и $(...) выполняются не при
+ * разборе, а перед запуском каждого элемента списка (Expander). Текст
+ * скрипта разбирается целиком до начала выполнения.
+ * Поддерживает интерактивный режим (чтение строк из входного потока,
+ * приглашение «$ ») и пакетный — выполнение текста скрипта (`-c` или файл)
+ * без приглашения и без сброса вывода после каждой строки.
+ */
+class Interpreter {
+public:
+    /**
+     * @param ctx Контекст выполнения.
+     * @param input Входной поток команд (stdin пайплайнов).
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     */
+    Interpreter(
+        ExecutionContext &ctx,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error
+    );
+
+    /**
+     * Выполняет одну строку. Ошибки лексера выводятся в поток ошибок.
+     * @param line Строка ввода.
+     * @return false, если была выполнена команда exit.
+     */
+    bool execute_line(const std::string &line);
+
+    /**
+     * Читает и выполняет строки из входного потока до конца ввода или exit.
+     * @param prompt Выводить ли приглашение (со сбросом вывода) перед строкой.
+     * @return Код завершения интерпретатора.
+     */
+    int run_interactive(bool prompt);
+
+    /**
+     * Разбирает текст скрипта целиком, затем выполняет его строки до конца
+     * или exit. После изменения набора команд (enable в скрипте) строки
+     * разбираются заново перед выполнением. Ошибка разбора строки
+     * выводится, когда до неё доходит очередь.
+     * @param script Текст скрипта.
+     * @return Код завершения интерпретатора.
+     */
+    int run_script(std::string_view script);
+
+    /**
+     * Читает файл скрипта целиком (большими блоками) и выполняет его.
+     * @param path Путь к файлу.
+     * @return Код завершения; 127, если файл не удалось прочитать.
+     */
+    int run_file(const std::string &path);
+
+private:
+    /** Строка скрипта, разобранная до начала выполнения. */
+    struct ScriptLine {
+        std::string_view text;
+        /** Список команд (пустой для пустой строки). */
+        CommandList list;
+        /** Сообщение об ошибке разбора (пустое, если ошибки нет). */
+        std::string error;
+    };
+
+    /**
+     * Разбирает строку в список команд (без подстановок).
+     * @throw std::runtime_error Ошибка лексера или парсера.
+     */
+    CommandList parse_text(std::string_view line);
+
+    /** Разбирает все строки скрипта с текущим контекстом. */
+    std::vector<ScriptLine> parse_script(std::string_view script);
+
+    /**
+     * Разбирает строку и сохраняет список команд в кэше.
+     * @return Список команд; nullptr для пустой строки или при ошибке
+     * разбора.
+     */
+    std::shared_ptr<const CommandList> parse_line(const std::string &line);
+
+    /** Сообщает о завершившихся фоновых заданиях (перед приглашением). */
+    void report_finished_jobs();
+
+    int exit_code() const;
+
+    ExecutionContext &ctx_;
+    std::istream &input_;
+    std::ostream &output_;
+    std::ostream &error_;
+    /** Память токенов текущей строки; освобождается после её разбора. */
+    LineArena arena_;
+    /** Разобранные ранее строки. */
+    PipeCache cache_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_INTERPRETER_HPP
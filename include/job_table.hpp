@@ -0,0 +1,111 @@
+#ifndef fluffy_tribble_JOB_TABLE_HPP
+#define fluffy_tribble_JOB_TABLE_HPP
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fluffy_tribble {
+
+/**
+ * Таблица фоновых заданий (command &). Задание выполняется в собственном
+ * потоке; номер задания — наименьший больший всех текущих (как в bash).
+ * Завершённое задание остаётся в таблице, пока его код не получен через
+ * wait или о нём не сообщено (list, take_finished).
+ */
+class JobTable {
+public:
+    /** Тело задания; возвращает код возврата. */
+    using Body = std::function<int()>;
+    /**
+     * Вызывается в потоке, забирающем завершённое задание из таблицы
+     * (например, чтобы вывести накопленный заданием вывод).
+     */
+    using Reap = std::function<void()>;
+
+    /** Состояние задания для вывода командой jobs. */
+    struct JobInfo {
+        int id = 0;
+        std::string command;
+        bool done = false;
+        /** Код возврата (для завершённого задания). */
+        int status = 0;
+    };
+
+    JobTable() = default;
+    JobTable(const JobTable &) = delete;
+    JobTable &operator=(const JobTable &) = delete;
+
+    /** Дожидается всех заданий (выход интерпретатора). */
+    ~JobTable();
+
+    /**
+     * Запускает задание.
+     * @param command Текст команды для jobs.
+     * @param body Тело задания; исключения перехватываются (код 1).
+     * @param reap Действие при удалении завершённого задания из таблицы.
+     * @return Номер задания.
+     */
+    int start(std::string command, Body body, Reap reap = {});
+
+    /**
+     * Дожидается задания и удаляет его из таблицы.
+     * @param id Номер задания.
+     * @return Код возврата или nullopt, если такого задания нет.
+     */
+    std::optional<int> wait(int id);
+
+    /** Дожидается всех заданий и очищает таблицу. */
+    void wait_all();
+
+    /**
+     * Состояние всех заданий; завершённые удаляются из таблицы.
+     * @return Задания по возрастанию номера.
+     */
+    std::vector<JobInfo> list();
+
+    /**
+     * Удаляет из таблицы завершённые задания.
+     * @return Удалённые задания по возрастанию номера.
+     */
+    std::vector<JobInfo> take_finished();
+
+    /**
+     * @return Число заданий в таблице.
+     */
+    std::size_t size() const;
+
+    /**
+     * Строка задания в формате jobs: «[1]  Running\tcmd &».
+     * @param job Задание.
+     * @return Строка без перевода строки.
+     */
+    static std::string describe(const JobInfo &job);
+
+private:
+    struct Job {
+        int id = 0;
+        std::string command;
+        std::thread thread;
+        /** Устанавливается потоком задания после записи status. */
+        std::atomic<bool> done{false};
+        int status = 0;
+        Reap reap;
+    };
+
+    /** Дожидается потока задания и выполняет reap. */
+    static JobInfo finish(Job &job);
+
+    mutable std::mutex mutex_;
+    std::map<int, std::unique_ptr<Job>> jobs_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_JOB_TABLE_HPP
@@ -1,7 +1,11 @@
 #ifndef fluffy_tribble_LEXER_HPP
 #define fluffy_tribble_LEXER_HPP
 
+#include <iosfwd>
+#include <string>
+#include <string_view>
 #include "execution_context.hpp"
+#include "line_arena.hpp"
 #include "token.hpp"
 
 namespace fluffy_tribble {
@@ -9,19 +13,48 @@ namespace fluffy_tribble {
 /**
  * Лексер: разбивает входную строку на токены с учётом quoting.
  * Одинарные и двойные кавычки обрабатываются; строка в кавычках — один аргумент
- * (WORD). Подстановка переменных окружения выполняется во время токенизации.
+ * (WORD). Подстановки переменных и вывода команд $(...) tokenize выполняет
+ * сразу, а tokenize_views только отмечает в токене: их выполняет Expander
+ * перед запуском пайплайна. Подставленный текст не делится на слова.
  */
 class Lexer {
 public:
     /**
-     * Разбивает входную строку на токены с подстановкой переменных.
+     * Разбивает входную строку на токены с подстановкой переменных и
+     * вывода команд (в момент разбора).
      * В одинарных кавычках (full quoting) переменные не подставляются.
      * В двойных кавычках (weak quoting) переменные подставляются.
      * @param input Входная строка (одна строка ввода пользователя).
      * @param ctx Контекст выполнения для подстановки переменных.
+     * @param error Поток ошибок команд $(...).
      * @return Поток токенов (включая EOF_ в конце).
      */
+    TokenStream tokenize(
+        const std::string &input,
+        ExecutionContext &ctx,
+        std::ostream &error
+    );
+
+    /**
+     * То же, что tokenize(input, ctx, error); ошибки команд $(...) выводятся
+     * в std::cerr.
+     */
     TokenStream tokenize(const std::string &input, ExecutionContext &ctx);
+
+    /**
+     * Разбивает строку на токены-представления без копирования: токен, текст
+     * которого совпадает с непрерывным участком входа, указывает в input;
+     * изменённый текст (экранирование, склейка кавычек) копируется в arena.
+     * Подстановки не выполняются: текст слова содержит всё, кроме них, а
+     * TokenView::expansions — их места, имена переменных и текст команд.
+     * Поэтому результат не зависит от контекста. Правила разбора те же, что
+     * у tokenize.
+     * @param input Входная строка; должна жить, пока используются токены.
+     * @param arena Арена строки: память потока токенов, изменённого текста
+     * и списков подстановок.
+     * @return Поток токенов (включая EOF_ в конце).
+     */
+    TokenViewStream tokenize_views(std::string_view input, LineArena &arena);
 };
 
 }  // namespace fluffy_tribble
@@ -0,0 +1,30 @@
+#ifndef fluffy_tribble_LEXER_SCAN_HPP
+#define fluffy_tribble_LEXER_SCAN_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace fluffy_tribble {
+
+/**
+ * Ищет конец участка «простых» байтов, начиная с pos: простые байты лексер
+ * добавляет к слову как есть в любом состоянии. Особые байты — `\`, `'`,
+ * `"`, `$`, `|`, `=`, `<`, `>`, `&`, пробельные (9–13, 32) и нулевой. На
+ * x86-64 проверяется по 16 байтов за раз (SSE2).
+ * @param input Входная строка.
+ * @param pos Начальная позиция.
+ * @return Позиция первого особого байта или input.size().
+ */
+std::size_t scan_plain(std::string_view input, std::size_t pos);
+
+/**
+ * Побайтовая версия scan_plain (для проверки и сравнения).
+ * @param input Входная строка.
+ * @param pos Начальная позиция.
+ * @return Позиция первого особого байта или input.size().
+ */
+std::size_t scan_plain_scalar(std::string_view input, std::size_t pos);
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_LEXER_SCAN_HPP
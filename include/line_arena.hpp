@@ -0,0 +1,49 @@
+#ifndef fluffy_tribble_LINE_ARENA_HPP
+#define fluffy_tribble_LINE_ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+namespace fluffy_tribble {
+
+/**
+ * Арена памяти одной строки ввода: токены и их изменённый текст выделяются
+ * последовательно (std::pmr::monotonic_buffer_resource) и освобождаются
+ * разом вызовом release() после выполнения строки. Небольшие строки
+ * умещаются во встроенный буфер и не обращаются к куче.
+ */
+class LineArena {
+public:
+    /** Размер встроенного буфера (в байтах). */
+    static constexpr std::size_t kInlineSize = 4096;
+
+    LineArena();
+
+    LineArena(const LineArena &) = delete;
+    LineArena &operator=(const LineArena &) = delete;
+
+    /**
+     * Копирует текст в арену.
+     * @param text Текст.
+     * @return Представление копии; действительно до release().
+     */
+    std::string_view store(std::string_view text);
+
+    /**
+     * @return Ресурс памяти для pmr-контейнеров строки.
+     */
+    std::pmr::memory_resource *resource();
+
+    /** Освобождает всё выделенное в арене. */
+    void release();
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, kInlineSize> inline_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_LINE_ARENA_HPP
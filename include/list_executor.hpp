@@ -0,0 +1,62 @@
+#ifndef fluffy_tribble_LIST_EXECUTOR_HPP
+#define fluffy_tribble_LIST_EXECUTOR_HPP
+
+#include <iosfwd>
+#include <span>
+#include "execution_context.hpp"
+#include "parsed_command.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * Выполняет список команд строки: пайплайны по порядку, пайплайн после && —
+ * только при успехе предыдущего, после || — только при неудаче (по
+ * ctx.last_status()). Подстановки в словах пайплайна (Expander)
+ * выполняются непосредственно перед его запуском. Цепочка пайплайнов,
+ * связанных && и ||, с & в конце выполняется в фоне целиком (задание в
+ * ExecutionContext::jobs()).
+ */
+class ListExecutor {
+public:
+    /**
+     * Выполняет список команд; останавливается после exit.
+     * @param list Список команд.
+     * @param input Входной поток.
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     * @param ctx Контекст выполнения.
+     */
+    static void execute(
+        const CommandList &list,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx
+    );
+
+    /**
+     * Запускает цепочку пайплайнов (связанных && и ||) фоновым заданием.
+     * Задание выполняется в отдельном потоке с копией контекста
+     * (присваивания и exit в нём не влияют на ctx) и с пустым вводом.
+     * Вывод в потоки с дескриптором (stream_fd) пишется в дескриптор
+     * напрямую; вывод в другие потоки копится и переносится в них, когда
+     * задание забирают из таблицы (wait, jobs). Номер задания записывается
+     * в переменную $!.
+     * @param chain Цепочка; оператор после последнего пайплайна не
+     * учитывается.
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     * @param ctx Контекст выполнения.
+     * @return Номер задания.
+     */
+    static int start_job(
+        std::span<const ListItem> chain,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx
+    );
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_LIST_EXECUTOR_HPP
@@ -0,0 +1,71 @@
+#ifndef fluffy_tribble_PARALLEL_RUNNER_HPP
+#define fluffy_tribble_PARALLEL_RUNNER_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * Выполняет шаблон команды для каждой строки входа на нескольких
+ * потоках-исполнителях (команда parallel). Встроенные команды выполняются
+ * в самих потоках, внешние — дочерними процессами; одновременно работает
+ * не больше jobs команд, то есть и процессов.
+ * Вывод каждой команды копится в SpillBuffer (первые kJobMemory байтов в
+ * памяти, остальное во временном файле) и выводится целиком после её
+ * завершения: по порядку входа с keep_order, иначе по мере готовности.
+ * Число взятых, но ещё не выведенных строк ограничено окном, поэтому
+ * память не зависит от числа строк. Исполнители запускаются по мере
+ * поступления строк: их не больше, чем строк.
+ */
+class ParallelRunner {
+public:
+    /** Сколько байтов вывода одной команды держать в памяти. */
+    static constexpr std::size_t kJobMemory = 1024 * 1024;
+
+    /** Наибольший код возврата (число неудачных команд ограничивается). */
+    static constexpr int kMaxStatus = 101;
+
+    /** Наибольшее число исполнителей; большее jobs уменьшается до него. */
+    static constexpr std::size_t kMaxJobs = 256;
+
+    /** Параметры запуска. */
+    struct Options {
+        /** Число исполнителей (не больше kMaxJobs); 0 — по числу ядер. */
+        std::size_t jobs = 0;
+        /** Выводить результаты в порядке строк входа (-k). */
+        bool keep_order = false;
+        /**
+         * Шаблон команды: {} в словах заменяется строкой входа; если {}
+         * нет, строка добавляется последним аргументом.
+         */
+        std::vector<std::string> command;
+        /** Окно строк в работе и в очереди вывода; 0 — 2 × jobs. */
+        std::size_t window = 0;
+    };
+
+    /**
+     * Выполняет шаблон для каждой непустой строки input. Команды получают
+     * пустой ввод; поток ошибок общий.
+     * @param options Параметры запуска.
+     * @param input Строки входа.
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     * @param ctx Контекст выполнения (только чтение окружения).
+     * @return Число завершившихся с ошибкой команд, не больше kMaxStatus.
+     */
+    static int run(
+        const Options &options,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx
+    );
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_PARALLEL_RUNNER_HPP
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include "command_id.hpp"
+#include "redirect.hpp"
+#include "word.hpp"
 
 namespace fluffy_tribble {
 
@@ -18,6 +20,15 @@ struct ParsedCommand {
     std::vector<std::string> args;
     /** Тип команды для диспетчеризации выполнения. */
     CommandID id = CommandID::EXTERNAL;
+    /** Перенаправления в порядке записи (последнее для потока главное). */
+    std::vector<Redirect> redirects;
+    /**
+     * Слова команды до подстановок, если хотя бы в одном есть $NAME, $! или
+     * $(...); иначе пусто. Для присваивания — одно слово значения. Пока
+     * подстановки не выполнены (Expander), name и args содержат слова в
+     * записи исходной строки.
+     */
+    std::vector<Word> words;
 };
 
 /**
@@ -25,6 +36,27 @@ struct ParsedCommand {
  */
 using Pipe = std::vector<ParsedCommand>;
 
+/** Как пайплайн списка команд выполняется относительно следующего. */
+enum class ListOp {
+    /** Дождаться завершения (; или конец строки). */
+    SEQUENCE,
+    /** Запустить в фоне и сразу перейти к следующему (&). */
+    BACKGROUND,
+    /** Следующий пайплайн — только при коде возврата 0 (&&). */
+    AND,
+    /** Следующий пайплайн — только при ненулевом коде возврата (||). */
+    OR
+};
+
+/** Элемент списка команд: пайплайн и оператор после него. */
+struct ListItem {
+    Pipe pipe;
+    ListOp op = ListOp::SEQUENCE;
+};
+
+/** Список команд строки: пайплайны, разделённые операторами. */
+using CommandList = std::vector<ListItem>;
+
 }  // namespace fluffy_tribble
 
 #endif  // fluffy_tribble_PARSED_COMMAND_HPP
@@ -0,0 +1,77 @@
+#ifndef fluffy_tribble_PATH_CACHE_HPP
+#define fluffy_tribble_PATH_CACHE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fluffy_tribble {
+
+/**
+ * Кэш путей к внешним программам, найденным по PATH (аналог hash в shell).
+ * Запись действительна, пока не изменились значение PATH и время
+ * модификации каталогов PATH, просмотренных при её поиске (появление
+ * программы в более раннем каталоге тоже сбрасывает запись).
+ * Потокобезопасен: используется стадиями пайплайна одновременно.
+ */
+class PathCache {
+public:
+    /** Запись кэша для вывода командой hash. */
+    struct Entry {
+        /** Имя команды. */
+        std::string name;
+        /** Найденный путь. */
+        std::string path;
+        /** Число запусков через кэш. */
+        std::size_t hits = 0;
+    };
+
+    /**
+     * Возвращает путь к программе name, при необходимости выполняя поиск по
+     * PATH, и учитывает запуск в счётчике hits.
+     * @param name Имя программы (имя со / возвращается как есть).
+     * @param path_env Текущее значение PATH.
+     * @return Найденный путь или name, если программа не найдена.
+     */
+    std::string resolve(const std::string &name, const std::string &path_env);
+
+    /**
+     * Ищет программу и заносит её в кэш, не увеличивая счётчик запусков.
+     * @param name Имя программы.
+     * @param path_env Текущее значение PATH.
+     * @return true, если программа найдена.
+     */
+    bool remember(const std::string &name, const std::string &path_env);
+
+    /** Очищает кэш. */
+    void clear();
+
+    /**
+     * Возвращает содержимое кэша, отсортированное по имени.
+     * @return Записи кэша.
+     */
+    std::vector<Entry> entries() const;
+
+private:
+    struct Cached {
+        std::string path;
+        std::size_t hits = 0;
+        /** Время модификации каталогов PATH до найденного включительно. */
+        std::vector<std::filesystem::file_time_type> mtimes;
+    };
+
+    Cached *lookup(const std::string &name, const std::string &path_env);
+    void reset_dirs(const std::string &path_env);
+
+    mutable std::mutex mutex_;
+    std::string path_env_;
+    std::vector<std::string> dirs_;
+    std::unordered_map<std::string, Cached> entries_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_PATH_CACHE_HPP
@@ -0,0 +1,80 @@
+#ifndef fluffy_tribble_PIPE_CACHE_HPP
+#define fluffy_tribble_PIPE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "parsed_command.hpp"
+
+namespace fluffy_tribble {
+
+/**
+ * LRU-кэш разобранных строк (списков команд) по тексту строки: повторно
+ * выполняемая строка не проходит заново через лексер и парсер. Подстановки
+ * в разобранной строке ещё не выполнены (их делает Expander при запуске),
+ * поэтому запись не зависит от значений переменных. Регистрация новых
+ * команд делает недействительными все записи: имя могло стать встроенной
+ * командой.
+ */
+class PipeCache {
+public:
+    /** Число записей по умолчанию. */
+    static constexpr std::size_t kDefaultCapacity = 256;
+
+    /**
+     * @param capacity Наибольшее число записей (не меньше 1).
+     */
+    explicit PipeCache(std::size_t capacity = kDefaultCapacity);
+
+    /**
+     * Ищет действительный список команд строки; найденная запись становится
+     * самой свежей.
+     * @param line Текст строки.
+     * @return Список команд или nullptr.
+     */
+    std::shared_ptr<const CommandList> find(std::string_view line);
+
+    /**
+     * Сохраняет список команд строки, вытесняя самую старую запись при
+     * переполнении.
+     * @param line Текст строки.
+     * @param list Результат разбора.
+     * @return Сохранённый список команд.
+     */
+    std::shared_ptr<const CommandList> insert(
+        std::string_view line,
+        CommandList list
+    );
+
+    /** Очищает кэш. */
+    void clear();
+
+    /**
+     * @return Число записей.
+     */
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::string line;
+        std::shared_ptr<const CommandList> list;
+        /** Поколение таблицы команд (CommandManager::generation) разбора. */
+        std::uint64_t commands_generation;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    std::size_t capacity_;
+    /** Записи от самой свежей к самой старой. */
+    EntryList entries_;
+    /** Ключи указывают на Entry::line (узлы списка не перемещаются). */
+    std::unordered_map<std::string_view, EntryList::iterator> index_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_PIPE_CACHE_HPP
@@ -1,23 +1,52 @@
 #ifndef fluffy_tribble_PIPE_EXECUTOR_HPP
 #define fluffy_tribble_PIPE_EXECUTOR_HPP
 
+#include <cstddef>
 #include <iosfwd>
 #include <vector>
 #include "execution_context.hpp"
 #include "parsed_command.hpp"
+#include "stage_stats.hpp"
 
 namespace fluffy_tribble {
 
 /**
- * Последовательно выполняет команды пайплайна (в первой части — одна команда).
- * Перенаправление потоков между командами не реализуется в этой части.
+ * Режим выполнения пайплайна.
+ */
+enum class PipeMode {
+    /** Стадии выполняются по очереди, вывод стадии целиком буферизуется. */
+    SEQUENTIAL,
+    /**
+     * Стадии выполняются одновременно и передают данные через ограниченные
+     * буферы (StreamChannel) с backpressure.
+     */
+    STREAMING
+};
+
+/**
+ * Выполняет команды пайплайна, перенаправляя вывод каждой команды на вход
+ * следующей.
  */
 class PipeExecutor {
 public:
     /**
-     * Выполняет все команды пайплайна по порядку.
-     * При установке ctx.is_exit() (команда exit) оставшиеся команды не
-     * запускаются.
+     * Имя переменной окружения, задающей режим: "sequential" или "streaming"
+     * (по умолчанию).
+     */
+    static constexpr const char *kModeEnv = "FLUFFY_PIPE_MODE";
+
+    /**
+     * Имя переменной окружения, задающей, сколько МиБ вывода стадии
+     * последовательный режим держит в памяти; остальное пишется во временный
+     * файл в каталоге TMPDIR.
+     */
+    static constexpr const char *kBufferEnv = "FLUFFY_PIPE_BUFFER_MB";
+
+    /** Предел памяти буфера между стадиями по умолчанию (МиБ). */
+    static constexpr std::size_t kDefaultBufferMiB = 64;
+
+    /**
+     * Выполняет пайплайн в режиме, заданном переменной kModeEnv.
      * @param pipe Пайплайн (вектор команд).
      * @param input Входной поток для первой команды.
      * @param output Выходной поток.
@@ -31,6 +60,58 @@ public:
         std::ostream &error,
         ExecutionContext &ctx
     );
+
+    /**
+     * Выполняет пайплайн в заданном режиме.
+     * При установке ctx.is_exit() (команда exit) оставшиеся команды не
+     * запускаются. Пайплайны с присваиванием или exit изменяют контекст и
+     * всегда выполняются последовательно.
+     * Пайплайн с префиксом time или при заданной переменной FLUFFY_TRACE
+     * выполняется с замерами стадий: time печатает отчёт в поток ошибок,
+     * трассировка записывает по одной записи JSON на стадию.
+     * @param pipe Пайплайн (вектор команд).
+     * @param input Входной поток для первой команды.
+     * @param output Выходной поток.
+     * @param error Поток ошибок.
+     * @param ctx Глобальный контекст выполнения.
+     * @param mode Режим выполнения.
+     */
+    static void execute(
+        const Pipe &pipe,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        PipeMode mode
+    );
+
+private:
+    static void execute_measured(
+        const Pipe &pipe,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        PipeMode mode
+    );
+
+    static void execute_sequential(
+        const Pipe &pipe,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        std::vector<StageStats> *stats = nullptr
+    );
+
+    static void execute_streaming(
+        const Pipe &pipe,
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx,
+        std::vector<StageStats> *stats = nullptr
+    );
 };
 
 }  // namespace fluffy_tribble
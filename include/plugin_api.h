@@ -0,0 +1,59 @@
+#ifndef fluffy_tribble_PLUGIN_API_H
+#define fluffy_tribble_PLUGIN_API_H
+
+/*
+ * Интерфейс встроенных команд из разделяемых библиотек (enable -f).
+ * Библиотека экспортирует для команды NAME функцию с C-связыванием
+ * fluffy_tribble_builtin_NAME типа fluffy_tribble_builtin_fn. Команда
+ * выполняется в процессе интерпретатора, как cat и wc: ввод и вывод идут
+ * через функции fluffy_tribble_io, а не через дескрипторы.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Префикс имени экспортируемой функции команды. */
+#define FLUFFY_TRIBBLE_BUILTIN_PREFIX "fluffy_tribble_builtin_"
+
+/** Потоки команды и окружение интерпретатора. */
+typedef struct fluffy_tribble_io {
+    /** Состояние интерпретатора; передаётся первым аргументом функций. */
+    void *state;
+    /**
+     * Читает до size байтов входа; ждёт, пока данных нет совсем.
+     * Возвращает число прочитанных байтов, 0 — конец ввода.
+     */
+    ptrdiff_t (*read)(void *state, char *buf, size_t size);
+    /**
+     * Пишет size байтов в поток stream: 1 — вывод, 2 — ошибки.
+     * Возвращает число записанных байтов или -1.
+     */
+    ptrdiff_t (*write)(void *state, int stream, const char *buf, size_t size);
+    /**
+     * Значение переменной окружения или NULL; действительно до конца
+     * выполнения команды.
+     */
+    const char *(*getenv)(void *state, const char *name);
+} fluffy_tribble_io;
+
+/**
+ * Функция команды.
+ * @param argc Число аргументов, включая имя команды.
+ * @param argv Аргументы (argv[0] — имя команды), завершены NULL.
+ * @param io Потоки и окружение.
+ * @return Код возврата команды.
+ */
+typedef int (*fluffy_tribble_builtin_fn)(
+    int argc,
+    char *const *argv,
+    const fluffy_tribble_io *io
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* fluffy_tribble_PLUGIN_API_H */
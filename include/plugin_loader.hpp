@@ -0,0 +1,47 @@
+#ifndef fluffy_tribble_PLUGIN_LOADER_HPP
+#define fluffy_tribble_PLUGIN_LOADER_HPP
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "command_manager.hpp"
+#include "plugin_api.h"
+
+namespace fluffy_tribble {
+
+/**
+ * Загрузка встроенных команд из разделяемых библиотек (enable -f).
+ * Функция команды NAME ищется по имени fluffy_tribble_builtin_NAME (см.
+ * plugin_api.h) и регистрируется в CommandManager. Библиотеки не
+ * выгружаются: их команды могут выполняться в любой момент.
+ */
+class PluginLoader {
+public:
+    /**
+     * Загружает библиотеку и регистрирует её команды.
+     * @param path Путь к библиотеке.
+     * @param names Имена команд.
+     * @param err Поток для сообщений об ошибках ("enable: ...").
+     * @return true, если зарегистрированы все команды.
+     */
+    static bool load(
+        const std::string &path,
+        const std::vector<std::string> &names,
+        std::ostream &err
+    );
+
+    /**
+     * Оборачивает C-функцию команды в реализацию для CommandManager.
+     * @param name Имя команды (argv[0]).
+     * @param fn Функция команды.
+     * @return Реализация.
+     */
+    static CommandManager::BuiltinFn wrap(
+        const std::string &name,
+        fluffy_tribble_builtin_fn fn
+    );
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_PLUGIN_LOADER_HPP
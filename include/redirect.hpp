@@ -0,0 +1,58 @@
+#ifndef fluffy_tribble_REDIRECT_HPP
+#define fluffy_tribble_REDIRECT_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "word.hpp"
+
+namespace fluffy_tribble {
+
+/** Вид перенаправления. */
+enum class RedirectKind {
+    /** < FILE — стандартный ввод из файла. */
+    INPUT,
+    /** > FILE — вывод в файл (файл усекается). */
+    OUTPUT,
+    /** >> FILE — вывод в конец файла. */
+    APPEND,
+    /** 2> FILE — поток ошибок в файл (файл усекается). */
+    ERROR_OUTPUT,
+    /** 2>> FILE — поток ошибок в конец файла. */
+    ERROR_APPEND
+};
+
+/** Перенаправление потока команды в файл или из файла. */
+struct Redirect {
+    RedirectKind kind = RedirectKind::OUTPUT;
+    /** Путь к файлу. */
+    std::string path;
+    /** Подстановки в пути; выполняются перед запуском команды. */
+    std::vector<Expansion> expansions;
+};
+
+/**
+ * Вид перенаправления по оператору.
+ * @param op Оператор: "<", ">", ">>", "2>" или "2>>".
+ * @return Вид перенаправления.
+ */
+RedirectKind redirect_kind(std::string_view op);
+
+/**
+ * Номер перенаправляемого потока: 0 — ввод, 1 — вывод, 2 — ошибки.
+ * @param kind Вид перенаправления.
+ * @return Номер потока.
+ */
+int redirect_target(RedirectKind kind);
+
+/**
+ * Открывает файл перенаправления (с O_CLOEXEC: дочерний процесс получает
+ * копию через dup2).
+ * @param redirect Перенаправление.
+ * @return Дескриптор или -1 (причина в errno).
+ */
+int open_redirect(const Redirect &redirect);
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_REDIRECT_HPP
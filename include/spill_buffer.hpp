@@ -0,0 +1,92 @@
+#ifndef fluffy_tribble_SPILL_BUFFER_HPP
+#define fluffy_tribble_SPILL_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace fluffy_tribble {
+
+class ExecutionContext;
+
+/**
+ * Буфер между стадиями последовательного пайплайна с ограниченной памятью:
+ * первые memory_limit байтов хранятся в памяти, остальные — во временном
+ * файле без имени (O_TMPFILE; где его нет — mkstemp и сразу unlink).
+ * Сначала в буфер пишут, затем rewind() переключает его на чтение
+ * записанного с начала; reset() очищает для повторного использования.
+ */
+class SpillBuffer : public std::streambuf {
+public:
+    /** Размер блока записи в файл и чтения из него. */
+    static constexpr std::size_t kFileBlock = 64 * 1024;
+
+    /**
+     * Каталог временных файлов для буферов команды.
+     * @param ctx Контекст выполнения.
+     * @return Значение TMPDIR, если оно задано и не пусто, иначе "/tmp".
+     */
+    static std::string temp_dir(const ExecutionContext &ctx);
+
+    /**
+     * @param memory_limit Сколько байтов держать в памяти.
+     * @param temp_dir Каталог временного файла.
+     */
+    SpillBuffer(std::size_t memory_limit, std::string temp_dir);
+    ~SpillBuffer() override;
+
+    SpillBuffer(const SpillBuffer &) = delete;
+    SpillBuffer &operator=(const SpillBuffer &) = delete;
+
+    /** Завершает запись и переключает буфер на чтение с начала. */
+    void rewind();
+
+    /** Очищает буфер и переключает его на запись. */
+    void reset();
+
+    /**
+     * @return Число записанных байтов.
+     */
+    std::uint64_t size() const;
+
+    /**
+     * @return true, если данные не уместились в память и пишутся в файл.
+     */
+    bool spilled() const;
+
+    /**
+     * @return true, если временный файл не удалось создать или записать
+     * (запись в буфер после этого не удаётся).
+     */
+    bool failed() const;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+    int_type underflow() override;
+    std::streamsize showmanyc() override;
+
+private:
+    /** Учитывает записанное в область записи (в память или в файл). */
+    bool commit_put();
+    bool open_file();
+    bool write_file(const char *data, std::size_t size);
+
+    std::size_t memory_limit_;
+    std::string temp_dir_;
+    std::vector<char> memory_;
+    std::size_t memory_used_ = 0;
+    std::vector<char> block_;
+    int fd_ = -1;
+    std::uint64_t file_size_ = 0;
+    std::uint64_t file_read_ = 0;
+    bool reading_ = false;
+    bool failed_ = false;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_SPILL_BUFFER_HPP
@@ -0,0 +1,168 @@
+#ifndef fluffy_tribble_STAGE_STATS_HPP
+#define fluffy_tribble_STAGE_STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "execution_context.hpp"
+#include "parsed_command.hpp"
+
+namespace fluffy_tribble {
+
+/** Процессорное время дочерних процессов (по wait4). */
+struct ChildUsage {
+    double user_seconds = 0;
+    double sys_seconds = 0;
+};
+
+/** Замеры одной стадии пайплайна (команда `time` и режим трассировки). */
+struct StageStats {
+    /** Текст команды стадии. */
+    std::string command;
+    /** Код возврата. */
+    int status = 0;
+    /** Время выполнения по часам. */
+    double wall_seconds = 0;
+    /** Процессорное время в режиме пользователя (поток + дочерние процессы). */
+    double user_seconds = 0;
+    /** Процессорное время в режиме ядра (поток + дочерние процессы). */
+    double sys_seconds = 0;
+    /** Байтов прочитано стадией из входного потока; пусто, если неизвестно. */
+    std::optional<std::uint64_t> bytes_in = 0;
+    /** Байтов записано стадией в выходной поток; пусто, если неизвестно. */
+    std::optional<std::uint64_t> bytes_out = 0;
+};
+
+/**
+ * Буфер-посредник, считающий байты, прошедшие через другой буфер потока.
+ * Сам данные не буферизует. Поток с таким буфером не связан с дескриптором
+ * (stream_fd возвращает -1), поэтому данные идут через него и учитываются.
+ */
+class CountingStreamBuf : public std::streambuf {
+public:
+    /**
+     * @param target Буфер, в который/из которого передаются данные.
+     */
+    explicit CountingStreamBuf(std::streambuf *target);
+
+    /**
+     * @return Число переданных байтов.
+     */
+    std::uint64_t count() const;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+    int_type underflow() override;
+    int_type uflow() override;
+    std::streamsize xsgetn(char *s, std::streamsize n) override;
+    std::streamsize showmanyc() override;
+
+private:
+    std::streambuf *target_;
+    std::uint64_t count_ = 0;
+};
+
+/**
+ * Замер стадии: подменяет её потоки считающими и засекает время по часам и
+ * процессорное время текущего потока; finish() заполняет StageStats.
+ * Потоки, связанные с дескриптором, не подменяются: программа получает сам
+ * дескриптор (терминал остаётся терминалом, cat копирует средствами ядра),
+ * а ретрансляция через поток могла бы ждать ввода с терминала уже после её
+ * завершения. Объём такого вывода в обычный файл берётся по смещению в
+ * файле, для терминала и канала он, как и объём такого ввода, неизвестен.
+ */
+class StageMeter {
+public:
+    /**
+     * @param stats Куда записать результат.
+     * @param input Входной поток стадии.
+     * @param output Выходной поток стадии.
+     */
+    StageMeter(StageStats &stats, std::istream &input, std::ostream &output);
+
+    StageMeter(const StageMeter &) = delete;
+    StageMeter &operator=(const StageMeter &) = delete;
+
+    /** @return Входной поток стадии (считающий, если без дескриптора). */
+    std::istream &input();
+    /** @return Выходной поток стадии (считающий, если без дескриптора). */
+    std::ostream &output();
+    /** @return Накопитель времени дочерних процессов стадии. */
+    ChildUsage &children();
+
+    /**
+     * Завершает замер.
+     * @param status Код возврата стадии.
+     */
+    void finish(int status);
+
+private:
+    StageStats &stats_;
+    std::istream &source_input_;
+    std::ostream &source_output_;
+    bool count_input_;
+    bool count_output_;
+    /** Размер или позиция файла вывода в начале замера. */
+    std::optional<std::uint64_t> out_start_;
+    CountingStreamBuf in_buf_;
+    CountingStreamBuf out_buf_;
+    std::istream input_;
+    std::ostream output_;
+    ChildUsage children_;
+    ChildUsage thread_start_;
+    std::chrono::steady_clock::time_point wall_start_;
+};
+
+/** Переменная окружения режима трассировки. */
+inline constexpr const char *kTraceEnv = "FLUFFY_TRACE";
+
+/**
+ * Текст команд стадии, как в командной строке ("a x | b").
+ * @param cmds Команды стадии.
+ * @return Текст.
+ */
+std::string describe_commands(std::span<const ParsedCommand> cmds);
+
+/**
+ * Печатает отчёт команды time: строка на стадию и итог.
+ * @param stats Замеры стадий.
+ * @param wall_seconds Общее время пайплайна по часам.
+ * @param out Поток для отчёта.
+ */
+void print_time_report(
+    const std::vector<StageStats> &stats,
+    double wall_seconds,
+    std::ostream &out
+);
+
+/**
+ * Записывает записи трассировки (одна строка JSON на стадию) туда, куда
+ * указывает FLUFFY_TRACE: "1" или "stderr" — в поток ошибок, иначе — в конец
+ * файла с этим именем.
+ * @param stats Замеры стадий.
+ * @param ctx Контекст (значение FLUFFY_TRACE).
+ * @param error Поток ошибок.
+ */
+void write_trace(
+    const std::vector<StageStats> &stats,
+    const ExecutionContext &ctx,
+    std::ostream &error
+);
+
+/**
+ * @param ctx Контекст.
+ * @return true, если включён режим трассировки (FLUFFY_TRACE не пуст).
+ */
+bool trace_enabled(const ExecutionContext &ctx);
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_STAGE_STATS_HPP
@@ -0,0 +1,135 @@
+#ifndef fluffy_tribble_STREAM_CHANNEL_HPP
+#define fluffy_tribble_STREAM_CHANNEL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace fluffy_tribble {
+
+/**
+ * Ограниченный кольцевой буфер между двумя одновременно работающими стадиями
+ * пайплайна. Писатель блокируется, пока буфер заполнен (backpressure),
+ * читатель — пока буфер пуст и сторона записи не закрыта.
+ */
+class StreamChannel {
+public:
+    /** Ёмкость буфера по умолчанию (в байтах). */
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+    /**
+     * Создаёт канал заданной ёмкости.
+     * @param capacity Максимальное число байт, ожидающих чтения.
+     */
+    explicit StreamChannel(std::size_t capacity = kDefaultCapacity);
+
+    /**
+     * Записывает size байт, блокируясь, пока в буфере нет места.
+     * @param data Данные для записи.
+     * @param size Число байт.
+     * @return false, если сторона чтения закрыта (данные отброшены).
+     */
+    bool write(const char *data, std::size_t size);
+
+    /**
+     * Читает до size байт, блокируясь, пока данных нет.
+     * @param data Буфер для чтения.
+     * @param size Размер буфера.
+     * @return Число прочитанных байт; 0 — конец данных.
+     */
+    std::size_t read(char *data, std::size_t size);
+
+    /**
+     * Возвращает число байт, доступных для чтения без блокировки.
+     * @return Число байт в буфере.
+     */
+    std::size_t available();
+
+    /** Закрывает сторону записи: читатель получит конец данных. */
+    void close_write();
+
+    /** Закрывает сторону чтения: писатель перестаёт блокироваться. */
+    void close_read();
+
+private:
+    std::vector<char> ring_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+    bool write_closed_ = false;
+    bool read_closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+};
+
+/**
+ * Буфер потока вывода, записывающий в StreamChannel.
+ * Данные накапливаются локально и передаются в канал блоками.
+ */
+class ChannelWriteBuf : public std::streambuf {
+public:
+    /**
+     * @param channel Канал, в который выполняется запись.
+     */
+    explicit ChannelWriteBuf(StreamChannel &channel);
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    bool flush_buffer();
+
+    StreamChannel &channel_;
+    std::vector<char> buffer_;
+};
+
+/**
+ * Буфер потока ввода, читающий из StreamChannel.
+ */
+class ChannelReadBuf : public std::streambuf {
+public:
+    /**
+     * @param channel Канал, из которого выполняется чтение.
+     */
+    explicit ChannelReadBuf(StreamChannel &channel);
+
+protected:
+    int_type underflow() override;
+    std::streamsize showmanyc() override;
+
+private:
+    StreamChannel &channel_;
+    std::vector<char> buffer_;
+};
+
+/**
+ * Буфер потока вывода, пересылающий данные в общий поток под мьютексом.
+ * Позволяет нескольким стадиям пайплайна писать в один поток ошибок.
+ */
+class SharedWriteBuf : public std::streambuf {
+public:
+    /**
+     * @param target Общий поток вывода.
+     * @param mutex Мьютекс, защищающий target.
+     */
+    SharedWriteBuf(std::ostream &target, std::mutex &mutex);
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    void flush_buffer();
+
+    std::ostream &target_;
+    std::mutex &mutex_;
+    std::vector<char> buffer_;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_STREAM_CHANNEL_HPP
@@ -1,8 +1,12 @@
 #ifndef fluffy_tribble_TOKEN_HPP
 #define fluffy_tribble_TOKEN_HPP
 
+#include <memory_resource>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "word.hpp"
 
 namespace fluffy_tribble {
 
@@ -14,6 +18,11 @@ enum class TokenType {
     OP_PIPE,       ///< Оператор пайпа |
     OP_ASSIGN,     ///< Оператор присваивания =
     OP_DOLLAR,     ///< Символ переменной $
+    OP_REDIRECT,   ///< Перенаправление <, >, >>, 2> или 2>>
+    OP_BACKGROUND, ///< Запуск в фоне &
+    OP_SEQUENCE,   ///< Разделитель команд ;
+    OP_AND,        ///< Выполнение при успехе &&
+    OP_OR,         ///< Выполнение при неудаче ||
     SPECIAL,       ///< Специальный символ
     EOF_           ///< Конец ввода
 };
@@ -31,6 +40,23 @@ struct Token {
  */
 using TokenStream = std::vector<Token>;
 
+/**
+ * Токен без владения текстом: значение указывает либо в исходную строку
+ * (если текст не изменялся), либо в LineArena (после снятия экранирования
+ * или склейки кавычек). Подстановки в слове не выполняются, а
+ * перечисляются в expansions (массив в LineArena).
+ */
+struct TokenView {
+    TokenType type;
+    std::string_view value;
+    std::span<const ExpansionView> expansions;
+};
+
+/**
+ * Поток токенов-представлений; память выделяется в LineArena.
+ */
+using TokenViewStream = std::pmr::vector<TokenView>;
+
 }  // namespace fluffy_tribble
 
 #endif  // fluffy_tribble_TOKEN_HPP
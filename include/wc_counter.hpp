@@ -0,0 +1,107 @@
+#ifndef fluffy_tribble_WC_COUNTER_HPP
+#define fluffy_tribble_WC_COUNTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace fluffy_tribble {
+
+/** Результат подсчёта wc. */
+struct WcCounts {
+    /** Число строк (незавершённая последняя строка тоже считается). */
+    std::size_t lines = 0;
+    /** Число слов — последовательностей непробельных байтов. */
+    std::size_t words = 0;
+    /** Число байтов (к незавершённой последней строке добавляется 1). */
+    std::size_t bytes = 0;
+};
+
+/** Реализация ядра подсчёта. */
+enum class WcKernel {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+/**
+ * Блочный подсчёт строк, слов и байтов для wc. Данные подаются кусками
+ * любого размера; внутри обрабатываются блоками по 64 байта: маски перевода
+ * строки и пробельных символов (байты 9–13 и 32) строятся векторными
+ * инструкциями, а начала слов находятся сдвигом маски. Ядро выбирается при
+ * запуске по возможностям процессора.
+ */
+class WcCounter {
+public:
+    /**
+     * @param kernel Ядро подсчёта; должно поддерживаться процессором.
+     */
+    explicit WcCounter(WcKernel kernel = best_kernel());
+
+    /**
+     * Обрабатывает очередной кусок данных.
+     * @param data Данные.
+     * @param size Размер в байтах.
+     */
+    void feed(const char *data, std::size_t size);
+
+    /**
+     * Обрабатывает очередной кусок данных.
+     * @param data Данные.
+     */
+    void feed(std::string_view data);
+
+    /**
+     * Возвращает итог по всем поданным данным.
+     * @return Строки, слова и байты.
+     */
+    WcCounts counts() const;
+
+    /**
+     * Подсчитывает строки, слова и байты в буфере.
+     * @param data Данные.
+     * @return Результат подсчёта.
+     */
+    static WcCounts count(std::string_view data);
+
+    /**
+     * Подсчитывает строки, слова и байты в буфере, разбивая его на части,
+     * которые обрабатываются в отдельных потоках. Слово, разрезанное границей
+     * частей, учитывается один раз.
+     * @param data Данные.
+     * @param threads Максимальное число потоков.
+     * @return Результат подсчёта.
+     */
+    static WcCounts count_parallel(std::string_view data, std::size_t threads);
+
+    /**
+     * @return Самое быстрое ядро, поддерживаемое процессором.
+     */
+    static WcKernel best_kernel();
+
+    /**
+     * @param kernel Ядро.
+     * @return true, если ядро поддерживается процессором.
+     */
+    static bool kernel_supported(WcKernel kernel);
+
+private:
+    static constexpr std::size_t kBlock = 64;
+    /** Минимальный размер части при параллельном подсчёте. */
+    static constexpr std::size_t kMinChunk = 8 * 1024 * 1024;
+
+    void feed_blocks(const unsigned char *data, std::size_t blocks);
+    void feed_tail(const unsigned char *data, std::size_t size);
+
+    WcKernel kernel_;
+    std::size_t newlines_ = 0;
+    std::size_t words_ = 0;
+    std::size_t size_ = 0;
+    /** Был ли последний обработанный байт пробельным (1) или нет (0). */
+    std::uint64_t prev_space_ = 1;
+    char last_ = '\n';
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_WC_COUNTER_HPP
@@ -0,0 +1,51 @@
+#ifndef fluffy_tribble_WORD_HPP
+#define fluffy_tribble_WORD_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fluffy_tribble {
+
+/** Вид подстановки в слове. */
+enum class ExpansionKind {
+    /** Значение переменной: $NAME или $!. */
+    VARIABLE,
+    /** Вывод команд: $(...). */
+    COMMAND
+};
+
+/**
+ * Подстановка в слове команды. Выполняется не при разборе, а перед запуском
+ * своего пайплайна (Expander), чтобы видеть результат предыдущих элементов
+ * списка команд.
+ */
+struct Expansion {
+    ExpansionKind kind = ExpansionKind::VARIABLE;
+    /** Позиция вставки в тексте слова (без кавычек и экранирования). */
+    std::size_t pos = 0;
+    /** Имя переменной или текст команд внутри $( ). */
+    std::string text;
+};
+
+/**
+ * Подстановка в токене-представлении: то же, что Expansion, но текст
+ * указывает во входную строку.
+ */
+struct ExpansionView {
+    ExpansionKind kind = ExpansionKind::VARIABLE;
+    std::size_t pos = 0;
+    std::string_view text;
+};
+
+/** Слово команды до подстановок: текст и места вставки значений. */
+struct Word {
+    std::string text;
+    /** Подстановки по возрастанию позиции. */
+    std::vector<Expansion> expansions;
+};
+
+}  // namespace fluffy_tribble
+
+#endif  // fluffy_tribble_WORD_HPP
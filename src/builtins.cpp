@@ -1,38 +1,167 @@
 #include "builtins.hpp"
-#include <fstream>
-#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <iomanip>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include "command_manager.hpp"
+#include "fd_stream.hpp"
+#include "parallel_runner.hpp"
+#include "plugin_loader.hpp"
+#include "wc_counter.hpp"
 
 namespace fluffy_tribble {
 
 namespace {
 
+constexpr std::size_t kCatBlock = 128 * 1024;
+
+/**
+ * Копирует поток без изменений. Уже буферизованные данные переносятся
+ * блоками; если их нет, читается одна строка, чтобы интерактивный ввод
+ * выводился сразу после ввода строки.
+ */
 void cat_stream(ReaderT &in, WriterT &out) {
+    std::vector<char> block(kCatBlock);
     std::string line;
-    while (std::getline(in, line)) {
-        out << line << '\n';
+    while (true) {
+        const std::streamsize avail = in.rdbuf()->in_avail();
+        if (avail > 0) {
+            const std::streamsize n = in.readsome(
+                block.data(),
+                std::min(avail, static_cast<std::streamsize>(block.size()))
+            );
+            out.write(block.data(), n);
+            continue;
+        }
+        if (!std::getline(in, line)) {
+            break;
+        }
+        out << line;
+        if (!in.eof()) {
+            out << '\n';
+        }
+    }
+}
+
+/**
+ * Копирует содержимое дескриптора в поток: напрямую средствами ядра, если
+ * поток сам связан с дескриптором, иначе блоками через буфер.
+ */
+bool cat_fd(int fd, WriterT &out) {
+    const int out_fd = stream_fd(out);
+    if (out_fd >= 0) {
+        out.flush();
+        return copy_fd(fd, out_fd);
+    }
+    std::vector<char> block(kCatBlock);
+    while (true) {
+        ssize_t n = read(fd, block.data(), block.size());
+        if (n == 0) {
+            return true;
+        }
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        out.write(block.data(), n);
     }
 }
 
+/** Файлы от этого размера отображаются в память и считаются параллельно. */
+constexpr std::size_t kWcMapThreshold = 16 * 1024 * 1024;
+
+/**
+ * Подсчитывает строки, слова и байты в файле: крупные обычные файлы
+ * отображаются в память и обрабатываются частями на всех ядрах, остальные
+ * читаются блоками.
+ * @return false, если файл не удалось открыть или прочитать.
+ */
+bool wc_file(const std::string &path, WcCounts &counts) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        static_cast<std::size_t>(st.st_size) >= kWcMapThreshold) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            close(fd);
+            madvise(data, size, MADV_WILLNEED);
+            counts = WcCounter::count_parallel(
+                std::string_view(static_cast<const char *>(data), size),
+                std::max(1U, std::thread::hardware_concurrency())
+            );
+            munmap(data, size);
+            return true;
+        }
+    }
+
+    WcCounter counter;
+    std::vector<char> block(kCatBlock);
+    bool ok = true;
+    while (true) {
+        ssize_t n = read(fd, block.data(), block.size());
+        if (n == 0) {
+            break;
+        }
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        counter.feed(block.data(), static_cast<std::size_t>(n));
+    }
+    close(fd);
+    counts = counter.counts();
+    return ok;
+}
+
 }  // namespace
 
 template <>
-void run<
+int run<
     CommandID::
         CAT>(const std::vector<std::string> &args, ReaderT &input, WriterT &output, WriterT &err, ExecutionContext &) {
     if (args.empty()) {
+        const auto *in_buf = dynamic_cast<const FdStreamBuf *>(input.rdbuf());
+        if (in_buf && input.rdbuf()->in_avail() == 0) {
+            return cat_fd(in_buf->fd(), output) ? 0 : 1;
+        }
         cat_stream(input, output);
-        return;
+        return 0;
     }
-    std::ifstream f(args[0]);
-    if (!f) {
+    const int fd = open(args[0].c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
         err << "cat: cannot open '" << args[0] << "'\n";
-        return;
+        return 1;
     }
-    cat_stream(f, output);
+    const bool ok = cat_fd(fd, output);
+    close(fd);
+    if (!ok) {
+        err << "cat: cannot read '" << args[0] << "'\n";
+        return 1;
+    }
+    return 0;
 }
 
 template <>
-void run<
+int run<
     CommandID::
         ECHO>(const std::vector<std::string> &args, ReaderT &, WriterT &output, WriterT &, ExecutionContext &) {
     for (std::size_t i = 0; i < args.size(); ++i) {
@@ -42,44 +171,56 @@ void run<
         output << args[i];
     }
     output << '\n';
+    return 0;
 }
 
 template <>
-void run<
+int run<
     CommandID::
         WC>(const std::vector<std::string> &args, ReaderT &input, WriterT &output, WriterT &err, ExecutionContext &) {
-    ReaderT *in = &input;
-    std::ifstream file;
-    if (!args.empty()) {
-        file.open(args[0]);
-        if (!file) {
-            err << "wc: cannot open '" << args[0] << "'\n";
-            return;
+    auto print = [&](const WcCounts &counts, const std::string *name) {
+        output << counts.lines << ' ' << counts.words << ' ' << counts.bytes;
+        if (name) {
+            output << ' ' << *name;
         }
-        in = &file;
+        output << '\n';
+    };
+
+    if (args.empty()) {
+        WcCounter counter;
+        std::vector<char> block(kCatBlock);
+        std::streambuf *buf = input.rdbuf();
+        std::streamsize n;
+        while ((n = buf->sgetn(block.data(), block.size())) > 0) {
+            counter.feed(block.data(), static_cast<std::size_t>(n));
+        }
+        print(counter.counts(), nullptr);
+        return 0;
     }
-    std::size_t lines = 0;
-    std::size_t words = 0;
-    std::size_t bytes = 0;
-    std::string line;
-    while (std::getline(*in, line)) {
-        ++lines;
-        bytes += line.size() + 1;  // + newline
-        std::istringstream iss(line);
-        std::string w;
-        while (iss >> w) {
-            ++words;
+
+    int status = 0;
+    WcCounts total;
+    for (const std::string &path : args) {
+        WcCounts counts;
+        if (!wc_file(path, counts)) {
+            err << "wc: cannot open '" << path << "'\n";
+            status = 1;
+            continue;
         }
+        print(counts, &path);
+        total.lines += counts.lines;
+        total.words += counts.words;
+        total.bytes += counts.bytes;
     }
-    output << lines << ' ' << words << ' ' << bytes;
-    if (!args.empty()) {
-        output << ' ' << args[0];
+    if (args.size() > 1) {
+        static const std::string kTotal = "total";
+        print(total, &kTotal);
     }
-    output << '\n';
+    return status;
 }
 
 template <>
-void run<CommandID::PWD>(
+int run<CommandID::PWD>(
     const std::vector<std::string> &,
     ReaderT &,
     WriterT &output,
@@ -87,26 +228,195 @@ void run<CommandID::PWD>(
     ExecutionContext &ctx
 ) {
     output << ctx.cwd() << '\n';
+    return 0;
+}
+
+template <>
+int run<CommandID::HASH>(
+    const std::vector<std::string> &args,
+    ReaderT &,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+) {
+    PathCache &cache = ctx.path_cache();
+    if (args.empty()) {
+        auto entries = cache.entries();
+        if (entries.empty()) {
+            output << "hash: hash table empty\n";
+            return 0;
+        }
+        output << "hits\tcommand\n";
+        for (const auto &entry : entries) {
+            output << std::setw(4) << entry.hits << '\t' << entry.path << '\n';
+        }
+        return 0;
+    }
+    for (const auto &arg : args) {
+        if (arg.starts_with('-') && arg != "-r") {
+            err << "hash: " << arg << ": invalid option\n"
+                << "hash: usage: hash [-r] [NAME...]\n";
+            return 2;
+        }
+    }
+    const auto &env = std::as_const(ctx).env();
+    auto path_it = env.find("PATH");
+    const std::string path_env = path_it != env.end() ? path_it->second : "";
+    int status = 0;
+    for (const auto &arg : args) {
+        if (arg == "-r") {
+            cache.clear();
+            continue;
+        }
+        if (!cache.remember(arg, path_env)) {
+            err << "hash: " << arg << ": not found\n";
+            status = 1;
+        }
+    }
+    return status;
 }
 
 template <>
-void run<CommandID::EXIT>(
+int run<CommandID::ENABLE>(
     const std::vector<std::string> &args,
     ReaderT &,
     WriterT &,
+    WriterT &err,
+    ExecutionContext &
+) {
+    if (args.size() < 3 || args[0] != "-f") {
+        err << "enable: usage: enable -f FILE NAME...\n";
+        return 2;
+    }
+    return !PluginLoader::load(
+        args[1], std::vector<std::string>(args.begin() + 2, args.end()), err
+    );
+}
+
+template <>
+int run<CommandID::JOBS>(
+    const std::vector<std::string> &,
+    ReaderT &,
+    WriterT &output,
     WriterT &,
     ExecutionContext &ctx
 ) {
+    for (const JobTable::JobInfo &job : ctx.jobs().list()) {
+        output << JobTable::describe(job) << '\n';
+    }
+    return 0;
+}
+
+int wait_jobs(
+    const std::vector<std::string> &args,
+    WriterT &err,
+    ExecutionContext &ctx
+) {
+    if (args.empty()) {
+        ctx.jobs().wait_all();
+        return 0;
+    }
+    int status = 0;
+    for (const std::string &arg : args) {
+        std::string_view number = arg;
+        if (number.starts_with('%')) {
+            number.remove_prefix(1);
+        }
+        int id = 0;
+        auto [end, ec] =
+            std::from_chars(number.data(), number.data() + number.size(), id);
+        std::optional<int> job_status;
+        if (ec == std::errc() && end == number.data() + number.size()) {
+            job_status = ctx.jobs().wait(id);
+        }
+        if (!job_status) {
+            err << "wait: " << arg << ": no such job\n";
+            status = 127;
+            continue;
+        }
+        status = *job_status;
+    }
+    return status;
+}
+
+int run_parallel(
+    const std::vector<std::string> &args,
+    ReaderT &input,
+    WriterT &output,
+    WriterT &err,
+    ExecutionContext &ctx
+) {
+    const auto usage = [&err]() {
+        err << "parallel: usage: parallel [-j N] [-k] COMMAND [ARG...]\n";
+        return 2;
+    };
+    ParallelRunner::Options options;
+    std::size_t i = 0;
+    for (; i < args.size(); ++i) {
+        std::string_view arg = args[i];
+        if (arg == "--") {
+            ++i;
+            break;
+        }
+        if (arg == "-k") {
+            options.keep_order = true;
+            continue;
+        }
+        if (!arg.starts_with("-j") && !arg.starts_with("-P")) {
+            break;
+        }
+        arg.remove_prefix(2);
+        if (arg.empty()) {
+            if (++i == args.size()) {
+                return usage();
+            }
+            arg = args[i];
+        }
+        auto [end, ec] = std::from_chars(
+            arg.data(), arg.data() + arg.size(), options.jobs
+        );
+        if (ec != std::errc() || end != arg.data() + arg.size() ||
+            options.jobs == 0) {
+            err << "parallel: " << arg << ": invalid number of jobs\n";
+            return 2;
+        }
+    }
+    if (i == args.size()) {
+        return usage();
+    }
+    if (CommandManager::get_command_id(args[i]) == CommandID::EXIT) {
+        err << "parallel: " << args[i] << ": cannot run in parallel\n";
+        return 2;
+    }
+    options.command.assign(args.begin() + i, args.end());
+    return ParallelRunner::run(options, input, output, err, ctx);
+}
+
+template <>
+int run<CommandID::EXIT>(
+    const std::vector<std::string> &args,
+    ReaderT &,
+    WriterT &,
+    WriterT &err,
+    ExecutionContext &ctx
+) {
+    if (args.size() > 1) {
+        err << "exit: too many arguments\n";
+        return 1;
+    }
     int code = 0;
     if (!args.empty()) {
-        try {
-            code = std::stoi(args[0]);
-        } catch (...) {
-            code = 0;
+        const std::string &arg = args[0];
+        auto [end, ec] =
+            std::from_chars(arg.data(), arg.data() + arg.size(), code);
+        if (ec != std::errc() || end != arg.data() + arg.size()) {
+            err << "exit: " << arg << ": numeric argument required\n";
+            code = 2;
         }
     }
     ctx.set_exit_code(code);
     ctx.set_exit(true);
+    return code;
 }
 
 }  // namespace fluffy_tribble
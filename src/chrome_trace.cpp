@@ -0,0 +1,144 @@
+#include "chrome_trace.hpp"
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+namespace fluffy_tribble {
+
+namespace {
+
+std::mutex trace_mutex;
+std::FILE *trace_file = nullptr;
+bool first_event = true;
+ChromeTrace::Clock::time_point trace_origin;
+/** Номер текущей записи: потоки заново получают имя в каждой записи. */
+unsigned trace_session = 0;
+
+std::atomic<std::uint32_t> next_tid{1};
+thread_local std::uint32_t thread_tid = 0;
+thread_local unsigned thread_named_session = 0;
+
+std::uint32_t current_tid() {
+    if (thread_tid == 0) {
+        thread_tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+    }
+    return thread_tid;
+}
+
+double micros(ChromeTrace::Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+/** Начинает очередное событие массива (вызывается под trace_mutex). */
+void begin_event() {
+    std::fputs(first_event ? "\n" : ",\n", trace_file);
+    first_event = false;
+}
+
+/** Пишет имя потока, если оно ещё не записано в этой записи. */
+void name_thread(std::uint32_t tid) {
+    if (thread_named_session == trace_session) {
+        return;
+    }
+    thread_named_session = trace_session;
+    begin_event();
+    std::fprintf(
+        trace_file,
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,"
+        "\"args\":{\"name\":\"thread %u\"}}",
+        static_cast<long>(getpid()),
+        tid,
+        tid
+    );
+}
+
+}  // namespace
+
+bool ChromeTrace::start(const std::string &path) {
+    stop();
+    std::lock_guard lock(trace_mutex);
+    trace_file = std::fopen(path.c_str(), "w");
+    if (!trace_file) {
+        return false;
+    }
+    first_event = true;
+    ++trace_session;
+    trace_origin = Clock::now();
+    std::fputc('[', trace_file);
+    begin_event();
+    std::fprintf(
+        trace_file,
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,"
+        "\"args\":{\"name\":\"fluffy-tribble\"}}",
+        static_cast<long>(getpid())
+    );
+    enabled_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void ChromeTrace::stop() {
+    std::lock_guard lock(trace_mutex);
+    enabled_.store(false, std::memory_order_relaxed);
+    if (!trace_file) {
+        return;
+    }
+    std::fputs("\n]\n", trace_file);
+    std::fclose(trace_file);
+    trace_file = nullptr;
+}
+
+void ChromeTrace::complete(
+    const char *category,
+    const char *name,
+    Clock::time_point begin,
+    Clock::time_point end,
+    std::string_view detail
+) {
+    const std::uint32_t tid = current_tid();
+    const std::string escaped = json_escape(detail);
+    std::lock_guard lock(trace_mutex);
+    // Запись могла завершиться, пока интервал был открыт.
+    if (!trace_file) {
+        return;
+    }
+    name_thread(tid);
+    begin_event();
+    std::fprintf(
+        trace_file,
+        "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+        "\"dur\":%.3f,\"pid\":%ld,\"tid\":%u",
+        name,
+        category,
+        micros(begin - trace_origin),
+        micros(end - begin),
+        static_cast<long>(getpid()),
+        tid
+    );
+    if (!escaped.empty()) {
+        std::fprintf(
+            trace_file, ",\"args\":{\"detail\":\"%s\"}", escaped.c_str()
+        );
+    }
+    std::fputc('}', trace_file);
+}
+
+std::string json_escape(std::string_view s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+}  // namespace fluffy_tribble
@@ -1,44 +1,231 @@
 #include "command_executor.hpp"
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <vector>
+#include "builtins.hpp"
+#include "chrome_trace.hpp"
 #include "command_manager.hpp"
 #include "external_runner.hpp"
+#include "fd_stream.hpp"
 
 namespace fluffy_tribble {
 
-void CommandExecutor::execute(
+namespace {
+
+/** Буфер файла перенаправления встроенной команды. */
+constexpr std::size_t kRedirectBuffer = 256 * 1024;
+
+/**
+ * Потоки встроенной команды с учётом её перенаправлений: перенаправленный
+ * поток заменяется потоком поверх FdStreamBuf файла, остальные остаются
+ * исходными (stream_fd по-прежнему узнаёт за ними дескриптор).
+ */
+class RedirectedStreams {
+public:
+    RedirectedStreams(
+        std::istream &input,
+        std::ostream &output,
+        std::ostream &error
+    )
+        : input_(&input), output_(&output), error_(&error) {}
+
+    RedirectedStreams(const RedirectedStreams &) = delete;
+    RedirectedStreams &operator=(const RedirectedStreams &) = delete;
+
+    /**
+     * Открывает файлы перенаправлений по порядку.
+     * @return false, если файл не открылся (сообщение записано в error()).
+     */
+    bool open(const std::vector<Redirect> &redirects) {
+        for (const Redirect &redirect : redirects) {
+            const int fd = open_redirect(redirect);
+            if (fd == -1) {
+                error() << "fluffy-tribble: " << redirect.path << ": "
+                        << std::strerror(errno) << '\n';
+                return false;
+            }
+            const int target = redirect_target(redirect.kind);
+            std::optional<FdStreamBuf> &buf = files_[target];
+            buf.reset();
+            buf.emplace(fd, true, kRedirectBuffer);
+            switch (target) {
+                case 0:
+                    file_input_.rdbuf(&*buf);
+                    input_ = &file_input_;
+                    break;
+                case 1:
+                    file_output_.rdbuf(&*buf);
+                    output_ = &file_output_;
+                    break;
+                default:
+                    file_error_.rdbuf(&*buf);
+                    error_ = &file_error_;
+                    break;
+            }
+        }
+        return true;
+    }
+
+    std::istream &input() { return *input_; }
+
+    std::ostream &output() { return *output_; }
+
+    std::ostream &error() { return *error_; }
+
+private:
+    std::array<std::optional<FdStreamBuf>, 3> files_;
+    std::istream file_input_{nullptr};
+    std::ostream file_output_{nullptr};
+    std::ostream file_error_{nullptr};
+    std::istream *input_;
+    std::ostream *output_;
+    std::ostream *error_;
+};
+
+int dispatch(
     const ParsedCommand &cmd,
     std::istream &input,
     std::ostream &output,
     std::ostream &error,
-    ExecutionContext &ctx
+    ExecutionContext &ctx,
+    ChildUsage *usage
 ) {
     switch (cmd.id) {
         case CommandID::ASSIGN: {
             if (cmd.args.size() == 1) {
                 ctx.set_env(cmd.name, cmd.args[0]);
             }
-            break;
+            return 0;
         }
         case CommandID::EXTERNAL: {
-            int status = ExternalRunner::run(
-                cmd.name, cmd.args, input, output, error, ctx
+            return ExternalRunner::run_chain(
+                std::span(&cmd, 1), input, output, error, ctx, usage
             );
-            ctx.set_last_status(status);
-            break;
+        }
+        case CommandID::PLUGIN: {
+            auto fn = CommandManager::get_builtin(cmd.name);
+            if (!fn) {
+                error << "fluffy-tribble: " << cmd.name
+                      << ": command not found\n";
+                return 127;
+            }
+            return (*fn)(cmd.args, input, output, error, ctx);
+        }
+        case CommandID::WAIT: {
+            return wait_jobs(cmd.args, error, ctx);
+        }
+        case CommandID::PARALLEL: {
+            return run_parallel(cmd.args, input, output, error, ctx);
+        }
+        case CommandID::TIME: {
+            // time внутри пайплайна замеряет только свою команду.
+            std::vector<StageStats> stats;
+            const auto start = std::chrono::steady_clock::now();
+            int status = 0;
+            if (!cmd.args.empty()) {
+                status = CommandExecutor::run(
+                    CommandExecutor::strip_time(cmd),
+                    input,
+                    output,
+                    error,
+                    ctx,
+                    &stats.emplace_back()
+                );
+            }
+            print_time_report(
+                stats,
+                std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start
+                )
+                    .count(),
+                error
+            );
+            return status;
         }
         default: {
             auto fn = CommandManager::get_command_fn(cmd.id);
-            if (fn) {
-                fn(cmd.args, input, output, error, ctx);
-                ctx.set_last_status(0);
-            }
+            return fn ? fn(cmd.args, input, output, error, ctx) : 0;
+        }
+    }
+}
 
-            if (!ctx.is_exit()) {
-                ctx.set_last_status(0);
-            }
+/** Выполняет команду, записывая замеры в stats, если он задан. */
+int measure(
+    const ParsedCommand &cmd,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    StageStats *stats
+) {
+    if (!stats) {
+        return dispatch(cmd, input, output, error, ctx, nullptr);
+    }
+    stats->command = describe_commands(std::span(&cmd, 1));
+    StageMeter meter(*stats, input, output);
+    int status = dispatch(
+        cmd, meter.input(), meter.output(), error, ctx, &meter.children()
+    );
+    meter.finish(status);
+    return status;
+}
 
-            break;
+}  // namespace
+
+void CommandExecutor::execute(
+    const ParsedCommand &cmd,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    StageStats *stats
+) {
+    int status = run(cmd, input, output, error, ctx, stats);
+    if (cmd.id != CommandID::ASSIGN && !ctx.is_exit()) {
+        ctx.set_last_status(status);
+    }
+}
+
+int CommandExecutor::run(
+    const ParsedCommand &cmd,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    StageStats *stats
+) {
+    TraceScope trace("command", "execute", cmd.name);
+    // Внешние программы получают файлы перенаправлений от ExternalRunner,
+    // time передаёт их замеряемой команде.
+    if (!cmd.redirects.empty() && cmd.id != CommandID::EXTERNAL &&
+        cmd.id != CommandID::TIME) {
+        RedirectedStreams streams(input, output, error);
+        if (!streams.open(cmd.redirects)) {
+            return 1;
         }
+        return measure(
+            cmd, streams.input(), streams.output(), streams.error(), ctx, stats
+        );
+    }
+    return measure(cmd, input, output, error, ctx, stats);
+}
+
+ParsedCommand CommandExecutor::strip_time(const ParsedCommand &cmd) {
+    ParsedCommand inner;
+    inner.name = cmd.args.front();
+    inner.args.assign(cmd.args.begin() + 1, cmd.args.end());
+    inner.id = CommandManager::get_command_id(inner.name);
+    if (inner.id == CommandID::EXTERNAL) {
+        inner.args.insert(inner.args.begin(), inner.name);
     }
+    inner.redirects = cmd.redirects;
+    return inner;
 }
 
-}  // namespace fluffy_tribble
\ No newline at end of file
+}  // namespace fluffy_tribble
@@ -1,8 +1,15 @@
 #include "command_manager.hpp"
-#include <cctype>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include "builtins.hpp"
 #include "execution_context.hpp"
 
@@ -10,48 +17,195 @@ namespace fluffy_tribble {
 
 namespace {
 
-std::unordered_map<std::string, CommandID> &name_to_id() {
-    static std::unordered_map<std::string, CommandID> map;
-    return map;
+constexpr unsigned char ascii_lower(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
 }
 
-std::string to_lower(std::string_view s) {
-    std::string out;
-    out.reserve(s.size());
-    for (unsigned char c : s) {
-        out += static_cast<char>(std::tolower(c));
+constexpr bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
     }
-    return out;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (ascii_lower(static_cast<unsigned char>(a[i])) !=
+            ascii_lower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Встроенная команда в таблице. */
+struct BuiltinName {
+    std::string_view name;
+    CommandID id = CommandID::EXTERNAL;
+};
+
+constexpr std::array<BuiltinName, 11> kBuiltinNames = {{
+    {"cat", CommandID::CAT},
+    {"echo", CommandID::ECHO},
+    {"wc", CommandID::WC},
+    {"pwd", CommandID::PWD},
+    {"hash", CommandID::HASH},
+    {"time", CommandID::TIME},
+    {"enable", CommandID::ENABLE},
+    {"jobs", CommandID::JOBS},
+    {"wait", CommandID::WAIT},
+    {"parallel", CommandID::PARALLEL},
+    {"exit", CommandID::EXIT},
+}};
+
+/** Размер таблицы встроенных команд (степень двойки). */
+constexpr std::size_t kBuiltinSlots = 16;
+
+/**
+ * Хеш имени для таблицы встроенных: первый и последний байты без учёта
+ * регистра и длина. Для имён kBuiltinNames он совершенен — без коллизий
+ * (проверяется при компиляции).
+ */
+constexpr std::size_t builtin_slot(std::string_view name) {
+    const std::size_t first = ascii_lower(name.front());
+    const std::size_t last = ascii_lower(name.back());
+    return (first + 2 * last + name.size()) & (kBuiltinSlots - 1);
 }
 
-bool init_default_commands() {
-    auto &m = name_to_id();
-    if (!m.empty()) {
+constexpr std::array<BuiltinName, kBuiltinSlots> kBuiltinTable = [] {
+    std::array<BuiltinName, kBuiltinSlots> table{};
+    for (const BuiltinName &builtin : kBuiltinNames) {
+        BuiltinName &slot = table[builtin_slot(builtin.name)];
+        if (!slot.name.empty()) {
+            throw "builtin_slot: collision, adjust the hash";
+        }
+        slot = builtin;
+    }
+    return table;
+}();
+
+CommandID find_builtin(std::string_view name) {
+    if (name.empty()) {
+        return CommandID::EXTERNAL;
+    }
+    const BuiltinName &slot = kBuiltinTable[builtin_slot(name)];
+    return iequals(slot.name, name) ? slot.id : CommandID::EXTERNAL;
+}
+
+/** Хеш без учёта регистра (FNV-1a) с поиском по string_view. */
+struct CaseInsensitiveHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const noexcept {
+        std::uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : s) {
+            h = (h ^ ascii_lower(c)) * 1099511628211ULL;
+        }
+        return static_cast<std::size_t>(h);
+    }
+};
+
+struct CaseInsensitiveEqual {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const noexcept {
+        return iequals(a, b);
+    }
+};
+
+/** Карта команд, зарегистрированных во время работы. */
+class RuntimeCommands {
+public:
+    struct Command {
+        CommandID id = CommandID::EXTERNAL;
+        std::shared_ptr<const CommandManager::BuiltinFn> fn;
+    };
+
+    bool find(std::string_view name, Command &command) const {
+        std::shared_lock lock(mutex_);
+        auto it = map_.find(name);
+        if (it == map_.end()) {
+            return false;
+        }
+        command = it->second;
         return true;
     }
-    m[to_lower("cat")] = CommandID::CAT;
-    m[to_lower("echo")] = CommandID::ECHO;
-    m[to_lower("wc")] = CommandID::WC;
-    m[to_lower("pwd")] = CommandID::PWD;
-    m[to_lower("exit")] = CommandID::EXIT;
-    return true;
+
+    void add(std::string_view name, Command command) {
+        std::unique_lock lock(mutex_);
+        auto it = map_.find(name);
+        if (it != map_.end()) {
+            it->second = std::move(command);
+        } else {
+            map_.emplace(std::string(name), std::move(command));
+        }
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<
+        std::string,
+        Command,
+        CaseInsensitiveHash,
+        CaseInsensitiveEqual>
+        map_;
+};
+
+RuntimeCommands &runtime_commands() {
+    static RuntimeCommands commands;
+    return commands;
+}
+
+/**
+ * Есть ли зарегистрированные команды. Пока их нет, поиск не обращается к
+ * карте (и к проверке инициализации её статической переменной).
+ */
+constinit std::atomic<bool> has_runtime_commands{false};
+
+constinit std::atomic<std::uint64_t> registry_generation{0};
+
+void add_runtime_command(std::string_view name, RuntimeCommands::Command cmd) {
+    runtime_commands().add(name, std::move(cmd));
+    has_runtime_commands.store(true, std::memory_order_release);
+    registry_generation.fetch_add(1, std::memory_order_acq_rel);
 }
 
 }  // namespace
 
-CommandID CommandManager::get_command_id(const std::string &name) {
-    static bool once = init_default_commands();
-    (void)once;
-    auto it = name_to_id().find(to_lower(name));
-    if (it == name_to_id().end()) {
-        return CommandID::EXTERNAL;
+CommandID CommandManager::get_command_id(std::string_view name) {
+    // Зарегистрированные имена имеют приоритет над встроенными.
+    if (has_runtime_commands.load(std::memory_order_acquire)) {
+        RuntimeCommands::Command command;
+        if (runtime_commands().find(name, command)) {
+            return command.id;
+        }
+    }
+    return find_builtin(name);
+}
+
+void CommandManager::register_command(std::string_view name, CommandID id) {
+    add_runtime_command(name, RuntimeCommands::Command{.id = id, .fn = {}});
+}
+
+void CommandManager::register_builtin(std::string_view name, BuiltinFn fn) {
+    add_runtime_command(
+        name,
+        RuntimeCommands::Command{
+            .id = CommandID::PLUGIN,
+            .fn = std::make_shared<const BuiltinFn>(std::move(fn)),
+        }
+    );
+}
+
+std::shared_ptr<const CommandManager::BuiltinFn> CommandManager::get_builtin(
+    std::string_view name
+) {
+    RuntimeCommands::Command command;
+    if (!has_runtime_commands.load(std::memory_order_acquire) ||
+        !runtime_commands().find(name, command)) {
+        return nullptr;
     }
-    return it->second;
+    return command.fn;
 }
 
-void CommandManager::register_command(const std::string &name, CommandID id) {
-    init_default_commands();
-    name_to_id()[to_lower(name)] = id;
+std::uint64_t CommandManager::generation() {
+    return registry_generation.load(std::memory_order_acquire);
 }
 
 CommandManager::CommandFn CommandManager::get_command_fn(CommandID id) {
@@ -64,6 +218,12 @@ CommandManager::CommandFn CommandManager::get_command_fn(CommandID id) {
             return &run<CommandID::WC>;
         case CommandID::PWD:
             return &run<CommandID::PWD>;
+        case CommandID::HASH:
+            return &run<CommandID::HASH>;
+        case CommandID::ENABLE:
+            return &run<CommandID::ENABLE>;
+        case CommandID::JOBS:
+            return &run<CommandID::JOBS>;
         case CommandID::EXIT:
             return &run<CommandID::EXIT>;
         default:
@@ -1,50 +1,159 @@
 #include "command_parser.hpp"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include "command_manager.hpp"
+#include "expander.hpp"
 #include "token.hpp"
 
 namespace fluffy_tribble {
 
-Pipe CommandParser::parse(const TokenStream &tokens) {
+namespace {
+
+/** Оператор списка команд для токена или nullopt. */
+std::optional<ListOp> list_op(TokenType type) {
+    switch (type) {
+        case TokenType::OP_SEQUENCE:
+            return ListOp::SEQUENCE;
+        case TokenType::OP_BACKGROUND:
+            return ListOp::BACKGROUND;
+        case TokenType::OP_AND:
+            return ListOp::AND;
+        case TokenType::OP_OR:
+            return ListOp::OR;
+        default:
+            return std::nullopt;
+    }
+}
+
+std::span<const ExpansionView> expansions_of(const Token &) {
+    return {};
+}
+
+std::span<const ExpansionView> expansions_of(const TokenView &token) {
+    return token.expansions;
+}
+
+/** Подстановки токена, сдвинутые на offset, в конец expansions. */
+template <typename T>
+void add_expansions(
+    const T &token,
+    std::size_t offset,
+    std::vector<Expansion> &expansions
+) {
+    for (const ExpansionView &e : expansions_of(token)) {
+        expansions.push_back(
+            Expansion{
+                .kind = e.kind,
+                .pos = offset + e.pos,
+                .text = std::string(e.text),
+            }
+        );
+    }
+}
+
+template <typename T>
+Word to_word(const T &token) {
+    Word word{.text = std::string(token.value), .expansions = {}};
+    add_expansions(token, 0, word.expansions);
+    return word;
+}
+
+/** Разбирает токены [begin, end) в пайплайн. */
+template <typename Tokens>
+Pipe parse_tokens(
+    const Tokens &tokens,
+    std::size_t begin,
+    std::size_t end
+) {
     Pipe pipe;
-    std::vector<std::string> words;
+    std::vector<Word> words;
+    std::vector<Redirect> redirects;
 
-    for (TokenStream::size_type i = 0; i < tokens.size(); ++i) {
-        const Token &t = tokens[i];
+    const auto finish_command = [&pipe, &words, &redirects]() {
+        if (words.empty()) {
+            if (!redirects.empty()) {
+                throw std::runtime_error("Redirection without a command");
+            }
+            return;
+        }
+        // Слова с подстановками сохраняются для Expander.
+        const bool deferred =
+            std::ranges::any_of(words, [](const Word &word) {
+                return !word.expansions.empty();
+            });
+        std::vector<std::string> texts;
+        texts.reserve(words.size());
+        for (Word &word : words) {
+            texts.push_back(
+                deferred ? Expander::source(word) : std::move(word.text)
+            );
+        }
+        ParsedCommand cmd = CommandParser::make_command(std::move(texts));
+        cmd.redirects = std::move(redirects);
+        if (deferred) {
+            cmd.words = std::move(words);
+        }
+        pipe.push_back(std::move(cmd));
+        words.clear();
+        redirects.clear();
+    };
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const auto &t = tokens[i];
         if (t.type == TokenType::EOF_) {
             break;
         }
+        if (list_op(t.type)) {
+            throw std::runtime_error("Unexpected " + std::string(t.value));
+        }
         if (t.type == TokenType::OP_PIPE) {
-            if (!words.empty()) {
-                ParsedCommand cmd;
-                cmd.name = std::move(words[0]);
-                words.erase(words.begin());
-                cmd.args.assign(words.begin(), words.end());
-                cmd.id = CommandManager::get_command_id(cmd.name);
-                if (cmd.id == CommandID::EXTERNAL) {
-                    cmd.args.insert(cmd.args.begin(), cmd.name);
-                }
-                pipe.push_back(std::move(cmd));
-                words.clear();
+            finish_command();
+            continue;
+        }
+        if (t.type == TokenType::OP_REDIRECT) {
+            if (i + 1 >= tokens.size() ||
+                tokens[i + 1].type != TokenType::WORD) {
+                throw std::runtime_error(
+                    "Missing file name after " + std::string(t.value)
+                );
             }
+            Word path = to_word(tokens[i + 1]);
+            redirects.push_back(
+                Redirect{
+                    .kind = redirect_kind(t.value),
+                    .path = std::move(path.text),
+                    .expansions = std::move(path.expansions),
+                }
+            );
+            ++i;
             continue;
         }
         if (t.type == TokenType::OP_DOLLAR && i + 2 < tokens.size() &&
             tokens[i + 1].type == TokenType::WORD &&
             tokens[i + 2].type == TokenType::OP_ASSIGN) {
-            std::string var_name = tokens[i + 1].value;
-            std::string value;
+            std::string var_name(tokens[i + 1].value);
+            Word value;
             if (i + 3 < tokens.size() &&
                 tokens[i + 3].type == TokenType::WORD) {
-                value = tokens[i + 3].value;
+                value = to_word(tokens[i + 3]);
                 i += 3;
             } else {
                 i += 2;
             }
             ParsedCommand assign;
             assign.name = std::move(var_name);
-            assign.args.push_back(std::move(value));
             assign.id = CommandID::ASSIGN;
+            if (value.expansions.empty()) {
+                assign.args.push_back(std::move(value.text));
+            } else {
+                assign.args.push_back(Expander::source(value));
+                assign.words.push_back(std::move(value));
+            }
             pipe.push_back(std::move(assign));
             continue;
         }
@@ -52,29 +161,91 @@ Pipe CommandParser::parse(const TokenStream &tokens) {
             if (i + 2 < tokens.size() &&
                 tokens[i + 1].type == TokenType::OP_ASSIGN &&
                 tokens[i + 2].type == TokenType::WORD) {
-                words.push_back(
-                    tokens[i].value + tokens[i + 1].value + tokens[i + 2].value
+                Word word = to_word(tokens[i]);
+                word.text.append(tokens[i + 1].value);
+                add_expansions(
+                    tokens[i + 2], word.text.size(), word.expansions
                 );
+                word.text.append(tokens[i + 2].value);
+                words.push_back(std::move(word));
                 i += 2;
                 continue;
             }
-            words.push_back(t.value);
+            words.push_back(to_word(t));
         }
     }
 
-    if (!words.empty()) {
-        ParsedCommand cmd;
-        cmd.name = std::move(words[0]);
-        words.erase(words.begin());
-        cmd.args.assign(words.begin(), words.end());
-        cmd.id = CommandManager::get_command_id(cmd.name);
-        if (cmd.id == CommandID::EXTERNAL) {
-            cmd.args.insert(cmd.args.begin(), cmd.name);
+    finish_command();
+    return pipe;
+}
+
+/** Делит токены на пайплайны по операторам списка. */
+template <typename Tokens>
+CommandList parse_list_tokens(const Tokens &tokens) {
+    CommandList list;
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        const TokenType type = tokens[i].type;
+        const std::optional<ListOp> op = list_op(type);
+        if (!op && type != TokenType::EOF_) {
+            continue;
         }
-        pipe.push_back(std::move(cmd));
+        Pipe pipe = parse_tokens(tokens, begin, i);
+        if (type == TokenType::EOF_) {
+            if (!pipe.empty()) {
+                list.push_back(ListItem{.pipe = std::move(pipe)});
+            } else if (!list.empty() && (list.back().op == ListOp::AND ||
+                                         list.back().op == ListOp::OR)) {
+                throw std::runtime_error(
+                    "Missing command after " +
+                    std::string(list.back().op == ListOp::AND ? "&&" : "||")
+                );
+            }
+            break;
+        }
+        if (pipe.empty()) {
+            throw std::runtime_error(
+                "Unexpected " + std::string(tokens[i].value)
+            );
+        }
+        list.push_back(ListItem{.pipe = std::move(pipe), .op = *op});
+        begin = i + 1;
     }
+    return list;
+}
 
-    return pipe;
+}  // namespace
+
+ParsedCommand CommandParser::make_command(std::vector<std::string> words) {
+    ParsedCommand cmd;
+    cmd.name = std::move(words[0]);
+    cmd.id = CommandManager::get_command_id(cmd.name);
+    if (cmd.id == CommandID::EXTERNAL) {
+        words[0] = cmd.name;
+        cmd.args = std::move(words);
+    } else {
+        cmd.args.assign(
+            std::make_move_iterator(words.begin() + 1),
+            std::make_move_iterator(words.end())
+        );
+    }
+    return cmd;
+}
+
+Pipe CommandParser::parse(const TokenStream &tokens) {
+    return parse_tokens(tokens, 0, tokens.size());
+}
+
+Pipe CommandParser::parse(const TokenViewStream &tokens) {
+    return parse_tokens(tokens, 0, tokens.size());
+}
+
+CommandList CommandParser::parse_list(const TokenStream &tokens) {
+    return parse_list_tokens(tokens);
+}
+
+CommandList CommandParser::parse_list(const TokenViewStream &tokens) {
+    return parse_list_tokens(tokens);
 }
 
 }  // namespace fluffy_tribble
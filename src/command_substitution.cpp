@@ -0,0 +1,80 @@
+#include "command_substitution.hpp"
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include "command_parser.hpp"
+#include "line_arena.hpp"
+#include "lexer.hpp"
+#include "list_executor.hpp"
+
+namespace fluffy_tribble {
+
+std::size_t CommandSubstitution::find_end(
+    std::string_view input,
+    std::size_t begin
+) {
+    int depth = 1;
+    bool in_single = false;
+    bool in_double = false;
+    for (std::size_t i = begin; i < input.size(); ++i) {
+        const char c = input[i];
+        if (in_single) {
+            in_single = c != '\'';
+            continue;
+        }
+        if (c == '\\') {
+            ++i;
+            continue;
+        }
+        if (c == '"') {
+            in_double = !in_double;
+            continue;
+        }
+        if (in_double) {
+            // Вложенная подстановка внутри двойных кавычек.
+            if (c == '$' && i + 1 < input.size() && input[i + 1] == '(') {
+                const std::size_t end = find_end(input, i + 2);
+                if (end == std::string_view::npos) {
+                    return end;
+                }
+                i = end;
+            }
+            continue;
+        }
+        if (c == '\'') {
+            in_single = true;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')' && --depth == 0) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+std::string CommandSubstitution::run(
+    std::string_view commands,
+    const ExecutionContext &ctx,
+    std::ostream &error
+) {
+    Lexer lexer;
+    CommandParser parser;
+    LineArena arena;
+    const CommandList list =
+        parser.parse_list(lexer.tokenize_views(commands, arena));
+
+    ExecutionContext sub_ctx(ctx);
+    std::istringstream input;
+    std::ostringstream output;
+    ListExecutor::execute(list, input, output, error, sub_ctx);
+    sub_ctx.jobs().wait_all();
+
+    std::string text = std::move(output).str();
+    while (!text.empty() && text.back() == '\n') {
+        text.pop_back();
+    }
+    return text;
+}
+
+}  // namespace fluffy_tribble
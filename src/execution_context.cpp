@@ -47,8 +47,40 @@ ExecutionContext::ExecutionContext() : cwd_(get_cwd()) {
     load_environ(env_);
 }
 
-ExecutionContext::EnvMap &ExecutionContext::env() {
-    return env_;
+ExecutionContext::ExecutionContext(const ExecutionContext &parent)
+    : env_(parent.env_),
+      env_version_(parent.env_version_.load()),
+      cwd_(parent.cwd_) {}
+
+ExecutionContext::EnvBlock::EnvBlock(const EnvMap &env, std::uint64_t version)
+    : version_(version) {
+    std::size_t total = 0;
+    for (const auto &[name, value] : env) {
+        total += name.size() + value.size() + 2;
+    }
+    storage_.reserve(total);
+    std::vector<std::size_t> offsets;
+    offsets.reserve(env.size());
+    for (const auto &[name, value] : env) {
+        if (name == kLastJobVar) {
+            continue;
+        }
+        offsets.push_back(storage_.size());
+        storage_.append(name).append(1, '=').append(value).append(1, '\0');
+    }
+    pointers_.reserve(env.size() + 1);
+    for (std::size_t offset : offsets) {
+        pointers_.push_back(storage_.data() + offset);
+    }
+    pointers_.push_back(nullptr);
+}
+
+char *const *ExecutionContext::EnvBlock::envp() const {
+    return pointers_.data();
+}
+
+std::uint64_t ExecutionContext::EnvBlock::version() const {
+    return version_;
 }
 
 const ExecutionContext::EnvMap &ExecutionContext::env() const {
@@ -59,7 +91,49 @@ void ExecutionContext::set_env(
     const std::string &name,
     const std::string &value
 ) {
-    env_[name] = value;
+    auto [it, inserted] = env_.try_emplace(name, value);
+    if (!inserted) {
+        if (it->second == value) {
+            return;
+        }
+        it->second = value;
+    }
+    ++env_version_;
+    if (name == "PATH") {
+        path_cache_.clear();
+    }
+}
+
+void ExecutionContext::unset_env(const std::string &name) {
+    if (env_.erase(name) == 0) {
+        return;
+    }
+    ++env_version_;
+    if (name == "PATH") {
+        path_cache_.clear();
+    }
+}
+
+std::uint64_t ExecutionContext::env_version() const {
+    return env_version_;
+}
+
+std::shared_ptr<const ExecutionContext::EnvBlock> ExecutionContext::env_block(
+) {
+    std::lock_guard lock(env_block_mutex_);
+    const std::uint64_t version = env_version_;
+    if (!env_block_ || env_block_->version() != version) {
+        env_block_ = std::make_shared<const EnvBlock>(env_, version);
+    }
+    return env_block_;
+}
+
+PathCache &ExecutionContext::path_cache() {
+    return path_cache_;
+}
+
+JobTable &ExecutionContext::jobs() {
+    return jobs_;
 }
 
 std::string ExecutionContext::cwd() const {
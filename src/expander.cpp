@@ -0,0 +1,122 @@
+#include "expander.hpp"
+#include <algorithm>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "command_parser.hpp"
+#include "command_substitution.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+bool has_expansions(const ParsedCommand &cmd) {
+    return !cmd.words.empty() ||
+           std::ranges::any_of(cmd.redirects, [](const Redirect &r) {
+               return !r.expansions.empty();
+           });
+}
+
+}  // namespace
+
+bool Expander::needs_expansion(const Pipe &pipe) {
+    return std::ranges::any_of(pipe, has_expansions);
+}
+
+std::string Expander::expand(
+    std::string_view text,
+    std::span<const Expansion> expansions,
+    const ExecutionContext &ctx,
+    std::ostream &error
+) {
+    std::string result;
+    std::size_t pos = 0;
+    for (const Expansion &expansion : expansions) {
+        result.append(text.substr(pos, expansion.pos - pos));
+        pos = expansion.pos;
+        if (expansion.kind == ExpansionKind::COMMAND) {
+            result += CommandSubstitution::run(expansion.text, ctx, error);
+            continue;
+        }
+        auto it = ctx.env().find(expansion.text);
+        if (it != ctx.env().end()) {
+            result += it->second;
+        }
+    }
+    result.append(text.substr(pos));
+    return result;
+}
+
+Pipe Expander::expand(
+    const Pipe &pipe,
+    const ExecutionContext &ctx,
+    std::ostream &error
+) {
+    Pipe expanded;
+    expanded.reserve(pipe.size());
+    for (const ParsedCommand &cmd : pipe) {
+        if (!has_expansions(cmd)) {
+            expanded.push_back(cmd);
+            continue;
+        }
+        ParsedCommand out;
+        if (cmd.id == CommandID::ASSIGN) {
+            out.name = cmd.name;
+            out.id = cmd.id;
+            out.args.push_back(
+                expand(
+                    cmd.words[0].text, cmd.words[0].expansions, ctx, error
+                )
+            );
+        } else if (!cmd.words.empty()) {
+            std::vector<std::string> words;
+            for (const Word &word : cmd.words) {
+                std::string text =
+                    expand(word.text, word.expansions, ctx, error);
+                if (!text.empty()) {
+                    words.push_back(std::move(text));
+                }
+            }
+            if (words.empty()) {
+                continue;
+            }
+            out = CommandParser::make_command(std::move(words));
+        } else {
+            out.name = cmd.name;
+            out.args = cmd.args;
+            out.id = cmd.id;
+        }
+        out.redirects.reserve(cmd.redirects.size());
+        for (const Redirect &redirect : cmd.redirects) {
+            out.redirects.push_back(
+                Redirect{
+                    .kind = redirect.kind,
+                    .path = expand(
+                        redirect.path, redirect.expansions, ctx, error
+                    ),
+                    .expansions = {},
+                }
+            );
+        }
+        expanded.push_back(std::move(out));
+    }
+    return expanded;
+}
+
+std::string Expander::source(const Word &word) {
+    std::string text;
+    std::size_t pos = 0;
+    for (const Expansion &expansion : word.expansions) {
+        text.append(word.text, pos, expansion.pos - pos);
+        pos = expansion.pos;
+        if (expansion.kind == ExpansionKind::COMMAND) {
+            text += "$(" + expansion.text + ')';
+        } else {
+            text += '$' + expansion.text;
+        }
+    }
+    text.append(word.text, pos);
+    return text;
+}
+
+}  // namespace fluffy_tribble
@@ -1,299 +1,760 @@
 #include "external_runner.hpp"
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
 #include <unistd.h>
 #include <algorithm>
+#include <array>
 #include <cerrno>
+#include <csignal>
 #include <cstring>
 #include <iostream>
-#include <iterator>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <thread>
+#include <utility>
 #include <vector>
-
-#ifdef __linux__
-#include <sys/wait.h>
-#endif
+#include "chrome_trace.hpp"
+#include "fd_stream.hpp"
+#include "redirect.hpp"
 
 namespace fluffy_tribble {
 
 namespace {
 
-std::string find_in_path(const std::string &name, const ExecutionContext &ctx) {
-    if (name.find('/') != std::string::npos) {
+std::string find_in_path(const std::string &name, ExecutionContext &ctx) {
+    const auto &env = std::as_const(ctx).env();
+    auto it = env.find("PATH");
+    if (it == env.end()) {
         return name;
     }
-    auto it = ctx.env().find("PATH");
-    if (it == ctx.env().end()) {
-        return name;
+    return ctx.path_cache().resolve(name, it->second);
+}
+
+/**
+ * Создаёт канал с флагом close-on-exec: дочерние процессы, запускаемые
+ * одновременно из других стадий пайплайна, не должны наследовать чужие
+ * концы каналов, иначе читатель не дождётся EOF.
+ */
+bool make_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC) == 0;
+#else
+    if (pipe(fds) == -1) {
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+#endif
+}
+
+void close_fd(int &fd) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
     }
-    const std::string &path_str = it->second;
-    std::string dir;
-    for (char c : path_str) {
-        if (c == ':') {
-            if (dir.empty()) {
-                continue;
-            }
-            std::string candidate = dir + "/" + name;
-            if (access(candidate.c_str(), X_OK) == 0) {
-                return candidate;
+}
+
+/**
+ * Запись в канал, читатель которого завершился, не должна убивать
+ * интерпретатор сигналом SIGPIPE: вместо этого write вернёт EPIPE.
+ * Дочерним процессам обработчик по умолчанию восстанавливает posix_spawn.
+ */
+void ignore_sigpipe() {
+    static std::once_flag once;
+    std::call_once(once, [] { std::signal(SIGPIPE, SIG_IGN); });
+}
+
+constexpr std::size_t kRelayMinBuffer = 64 * 1024;
+constexpr std::size_t kRelayMaxBuffer = 1024 * 1024;
+
+/** Буфер пересылки, растущий вдвое, пока данные заполняют его целиком. */
+struct RelayBuffer {
+    std::vector<char> data = std::vector<char>(kRelayMinBuffer);
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    void grow_if_full(std::size_t filled) {
+        if (filled == data.size() && data.size() < kRelayMaxBuffer) {
+            data.resize(data.size() * 2);
+        }
+    }
+};
+
+void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/**
+ * Открывает pidfd дочернего процесса (Linux 5.3+, с close-on-exec): он
+ * становится читаемым, когда процесс завершился.
+ * @return Дескриптор или -1, если pidfd недоступен.
+ */
+int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+/** Завершение дочернего процесса: код и время по wait4 именно его pid. */
+struct ChildExit {
+    pid_t pid = -1;
+    /** Путь программы — подробность события трассировки. */
+    std::string_view path;
+    /** pidfd процесса; -1, если он недоступен или процесс уже собран. */
+    int pidfd = -1;
+    /** wait4 вернул этот процесс: status и usage заполнены. */
+    bool reaped = false;
+    int status = 0;
+    rusage usage{};
+
+    /**
+     * Собирает процесс: без ожидания, если уже известно, что он завершился
+     * (pidfd читаем), иначе блокирующе.
+     */
+    void reap(bool block) {
+        TraceScope trace("process", "wait", path);
+        const pid_t rc = wait4(pid, &status, block ? 0 : WNOHANG, &usage);
+        if (rc == pid || rc == -1) {
+            reaped = rc == pid;
+            close_fd(pidfd);
+        }
+    }
+};
+
+/**
+ * Пересылает данные между потоками интерпретатора и концами каналов цепочки
+ * в одном цикле poll() в вызывающем потоке: ввод из istream в stdin первой
+ * программы, stdout последней и общий stderr — в соответствующие ostream.
+ * Дескрипторы закрываются по мере достижения конца данных. Если istream
+ * пока пуст, а программы ещё пишут, ожидание ввода уходит в отдельный поток,
+ * чтобы не перестать вычитывать их stdout и stderr. В тот же poll() входят
+ * pidfd программ (watch): завершившаяся программа собирается сразу, без
+ * блокирующего waitpid и без общего обработчика SIGCHLD.
+ */
+class RelayLoop {
+public:
+    RelayLoop(
+        std::istream &input,
+        int in_fd,
+        std::ostream &output,
+        int out_fd,
+        std::ostream &error,
+        int err_fd
+    )
+        : input_(input),
+          output_(output),
+          error_(error),
+          in_fd_(in_fd),
+          out_fd_(out_fd),
+          err_fd_(err_fd) {
+        for (int fd : {in_fd_, out_fd_, err_fd_}) {
+            if (fd >= 0) {
+                set_nonblocking(fd);
             }
-            dir.clear();
-        } else {
-            dir += c;
         }
     }
-    if (!dir.empty()) {
-        std::string candidate = dir + "/" + name;
-        if (access(candidate.c_str(), X_OK) == 0) {
-            return candidate;
+
+    RelayLoop(const RelayLoop &) = delete;
+    RelayLoop &operator=(const RelayLoop &) = delete;
+
+    /**
+     * Ждать в цикле и завершения программы (если у неё есть pidfd).
+     * @param child Программа; должна жить до конца run().
+     */
+    void watch(ChildExit &child) {
+        if (child.pidfd >= 0) {
+            children_.push_back(&child);
         }
     }
-    return name;
-}
 
-std::vector<std::string> env_to_vector(const ExecutionContext::EnvMap &env) {
-    std::vector<std::string> out;
-    out.reserve(env.size());
-    std::ranges::transform(env, std::back_inserter(out), [](const auto &p) {
-        return p.first + "=" + p.second;
-    });
-    return out;
-}
+    ~RelayLoop() {
+        if (feeder_.joinable()) {
+            feeder_.join();
+        }
+        close_fd(in_fd_);
+        close_fd(out_fd_);
+        close_fd(err_fd_);
+    }
 
-int get_fd_from_stream(const std::ios &stream) {
-    if (&stream == &std::cin) {
-        return STDIN_FILENO;
+    void run() {
+        while (in_fd_ >= 0 || out_fd_ >= 0 || err_fd_ >= 0 ||
+               !children_.empty()) {
+            if (in_fd_ >= 0 && in_buf_.begin == in_buf_.end) {
+                take_input();
+                continue;
+            }
+
+            fds_.clear();
+            for (int fd : {in_fd_, out_fd_, err_fd_}) {
+                if (fd >= 0) {
+                    fds_.push_back(
+                        pollfd{
+                            .fd = fd,
+                            .events = static_cast<short>(
+                                fd == in_fd_ ? POLLOUT : POLLIN
+                            ),
+                            .revents = 0
+                        }
+                    );
+                }
+            }
+            for (const ChildExit *child : children_) {
+                fds_.push_back(
+                    pollfd{.fd = child->pidfd, .events = POLLIN, .revents = 0}
+                );
+            }
+            if (poll(fds_.data(), fds_.size(), -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            for (const pollfd &ready : fds_) {
+                if (ready.revents == 0) {
+                    continue;
+                }
+                if (ready.fd == in_fd_) {
+                    drain_input();
+                } else if (ready.fd == out_fd_) {
+                    forward(out_fd_, output_, out_buf_);
+                } else if (ready.fd == err_fd_) {
+                    forward(err_fd_, error_, err_buf_);
+                } else {
+                    reap_exited(ready.fd);
+                }
+            }
+        }
     }
-    if (&stream == &std::cout) {
-        return STDOUT_FILENO;
+
+private:
+    /** Собирает завершившуюся программу с данным pidfd. */
+    void reap_exited(int pidfd) {
+        auto it = std::ranges::find(children_, pidfd, &ChildExit::pidfd);
+        if (it == children_.end()) {
+            return;
+        }
+        (*it)->reap(false);
+        if ((*it)->pidfd < 0) {
+            children_.erase(it);
+        }
     }
-    if (&stream == &std::cerr) {
-        return STDERR_FILENO;
+
+    /**
+     * Пополняет буфер ввода, не блокируясь, пока есть что вычитывать из
+     * программ: при пустом istream чтение передаётся потоку feed().
+     */
+    void take_input() {
+        std::streambuf *buf = input_.rdbuf();
+        const std::streamsize avail = buf ? buf->in_avail() : -1;
+        if (avail < 0) {
+            close_fd(in_fd_);
+        } else if (avail > 0 || (out_fd_ < 0 && err_fd_ < 0)) {
+            if (!fill_input()) {
+                close_fd(in_fd_);
+            }
+        } else {
+            const int fd = std::exchange(in_fd_, -1);
+            feeder_ = std::thread(&RelayLoop::feed, this, fd);
+        }
     }
-    return -1;
-}
 
-void write_stream_to_fd(std::istream &in, int fd) {
-    char buffer[4096];
-    while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
-        std::streamsize n = in.gcount();
-        ssize_t written = 0;
-        while (written < n) {
-            ssize_t ret = write(fd, buffer + written, n - written);
-            if (ret == -1) {
+    /**
+     * Берёт из istream уже доступные данные, блокируясь только если их нет
+     * совсем (например, предыдущая стадия ещё не записала очередной блок).
+     * @return false в конце ввода.
+     */
+    bool fill_input() {
+        std::streambuf *buf = input_.rdbuf();
+        std::streamsize n = 0;
+        if (buf && buf->sgetc() != std::char_traits<char>::eof()) {
+            const auto size = static_cast<std::streamsize>(in_buf_.data.size());
+            n = std::min(std::max<std::streamsize>(buf->in_avail(), 1), size);
+            n = buf->sgetn(in_buf_.data.data(), n);
+        }
+        if (n <= 0) {
+            return false;
+        }
+        in_buf_.begin = 0;
+        in_buf_.end = static_cast<std::size_t>(n);
+        in_buf_.grow_if_full(in_buf_.end);
+        return true;
+    }
+
+    /**
+     * Поток подачи ввода: блокирующе читает istream и пишет в stdin первой
+     * программы, дожидаясь места в канале. Владеет дескриптором fd.
+     */
+    void feed(int fd) {
+        while (fd >= 0 && fill_input()) {
+            while (in_buf_.begin < in_buf_.end) {
+                ssize_t n = write(
+                    fd,
+                    in_buf_.data.data() + in_buf_.begin,
+                    in_buf_.end - in_buf_.begin
+                );
+                if (n > 0) {
+                    in_buf_.begin += static_cast<std::size_t>(n);
+                    continue;
+                }
+                if (n == -1 && errno == EINTR) {
+                    continue;
+                }
+                pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+                if (n == -1 && errno == EAGAIN &&
+                    (poll(&pfd, 1, -1) != -1 || errno == EINTR)) {
+                    continue;
+                }
+                // Программа закрыла stdin (EPIPE): остаток ввода не нужен.
+                close_fd(fd);
+                break;
+            }
+        }
+        close_fd(fd);
+    }
+
+    void drain_input() {
+        while (in_buf_.begin < in_buf_.end) {
+            ssize_t n = write(
+                in_fd_,
+                in_buf_.data.data() + in_buf_.begin,
+                in_buf_.end - in_buf_.begin
+            );
+            if (n > 0) {
+                in_buf_.begin += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n == -1 && (errno == EAGAIN || errno == EINTR)) {
                 return;
             }
-            written += ret;
+            // Программа закрыла stdin (EPIPE): остаток ввода не нужен.
+            close_fd(in_fd_);
+            return;
         }
     }
-}
 
-void read_fd_to_stream(int fd, std::ostream &out) {
-    char buffer[4096];
-    ssize_t n;
-    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
-        out.write(buffer, n);
+    static void forward(int &fd, std::ostream &out, RelayBuffer &buffer) {
+        while (true) {
+            ssize_t n = read(fd, buffer.data.data(), buffer.data.size());
+            if (n > 0) {
+                out.write(buffer.data.data(), n);
+                buffer.grow_if_full(static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == -1 && (errno == EAGAIN || errno == EINTR)) {
+                return;
+            }
+            close_fd(fd);
+            return;
+        }
     }
-}
 
-}  // namespace
+    std::istream &input_;
+    std::ostream &output_;
+    std::ostream &error_;
+    int in_fd_;
+    int out_fd_;
+    int err_fd_;
+    RelayBuffer in_buf_;
+    RelayBuffer out_buf_;
+    RelayBuffer err_buf_;
+    std::thread feeder_;
+    /** Программы, завершения которых ещё ждёт цикл. */
+    std::vector<ChildExit *> children_;
+    std::vector<pollfd> fds_;
+};
+
+/** Одна программа цепочки: имя, аргументы и перенаправления команды. */
+struct ProcessSpec {
+    const std::string *name;
+    const std::vector<std::string> *args;
+    const std::vector<Redirect> *redirects = nullptr;
+};
+
+/** Подготовленный к запуску процесс цепочки. */
+struct Process {
+    std::string path;
+    std::vector<std::string> argv_strings;
+    std::vector<char *> argv;
+    bool found = false;
+    /** Файл перенаправления не открылся: процесс не запускается. */
+    bool redirect_failed = false;
+    /** Открытые файлы перенаправлений для stdin, stdout и stderr. */
+    std::array<int, 3> files = {-1, -1, -1};
+    int in_fd = -1;
+    int out_fd = -1;
+    int err_fd = -1;
+    ChildExit child;
+    int spawn_status = -1;
+};
+
+/**
+ * Сообщение об ошибке процесса: в его файл stderr, если он перенаправлен,
+ * иначе в общий поток ошибок.
+ */
+void report(const Process &proc, std::ostream &error, std::string line) {
+    line += '\n';
+    if (proc.files[STDERR_FILENO] < 0) {
+        error << line;
+        return;
+    }
+    [[maybe_unused]] ssize_t n =
+        write(proc.files[STDERR_FILENO], line.data(), line.size());
+}
 
-int ExternalRunner::run(
-    const std::string &name,
-    const std::vector<std::string> &args,
-    std::istream &input,
-    std::ostream &output,
-    std::ostream &error,
-    ExecutionContext &ctx
+/**
+ * Открывает файлы перенаправлений процесса; файл, перекрытый более поздним
+ * перенаправлением того же потока, всё равно создаётся (как в POSIX sh).
+ * @return false, если файл не открылся (сообщение записано в error).
+ */
+bool open_files(
+    Process &proc,
+    const std::vector<Redirect> &redirects,
+    std::ostream &error
 ) {
-    std::string path = find_in_path(name, ctx);
+    for (const Redirect &redirect : redirects) {
+        const int fd = open_redirect(redirect);
+        if (fd == -1) {
+            report(
+                proc,
+                error,
+                "fluffy-tribble: " + redirect.path + ": " + std::strerror(errno)
+            );
+            return false;
+        }
+        int &slot = proc.files[redirect_target(redirect.kind)];
+        close_fd(slot);
+        slot = fd;
+    }
+    return true;
+}
 
-    if (access(path.c_str(), F_OK) != 0) {
-        error << "fluffy-tribble: " << name << ": command not found" << '\n';
+/**
+ * Запускает процесс через posix_spawn: в отличие от fork() не копирует
+ * таблицы страниц родителя (glibc использует clone(CLONE_VM | CLONE_VFORK))
+ * и безопасен для многопоточного процесса. Перенаправления выполняются
+ * файловыми действиями posix_spawn.
+ * @return 0 или код ошибки запуска (errno).
+ */
+int spawn_child(Process &proc, char *const envp[]) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    posix_spawn_file_actions_adddup2(&actions, proc.in_fd, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, proc.out_fd, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, proc.err_fd, STDERR_FILENO);
+
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+    int rc = posix_spawn(
+        &proc.child.pid,
+        proc.path.c_str(),
+        &actions,
+        &attr,
+        proc.argv.data(),
+        envp
+    );
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc != 0) {
+        proc.child.pid = -1;
+    } else {
+        proc.child.path = proc.path;
+        proc.child.pidfd = open_pidfd(proc.child.pid);
+    }
+    return rc;
+}
+
+int spawn_error_status(int err) {
+    if (err == ENOENT) {
         return 127;
     }
+    if (err == EACCES) {
+        return 126;
+    }
+    return 1;
+}
 
-    std::vector<std::string> env_vec = env_to_vector(ctx.env());
-    std::vector<std::string> argv_strings;
+double to_seconds(const timeval &tv) {
+    return static_cast<double>(tv.tv_sec) +
+           static_cast<double>(tv.tv_usec) / 1e6;
+}
 
-    if (!args.empty()) {
-        argv_strings = args;
-    } else {
-        argv_strings.push_back(path);
+int decode_status(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
     }
-
-    std::vector<char *> argv;
-    argv.reserve(argv_strings.size() + 1);
-    for (auto &s : argv_strings) {
-        argv.push_back(const_cast<char *>(s.c_str()));
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
     }
-    argv.push_back(nullptr);
+    return -1;
+}
 
-    std::vector<char *> envp;
-    envp.reserve(env_vec.size() + 1);
-    for (auto &s : env_vec) {
-        envp.push_back(const_cast<char *>(s.c_str()));
+int run_processes(
+    const std::vector<ProcessSpec> &specs,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    ChildUsage *usage
+) {
+    ignore_sigpipe();
+
+    std::vector<Process> procs(specs.size());
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        Process &proc = procs[i];
+        if (specs[i].redirects &&
+            !open_files(proc, *specs[i].redirects, error)) {
+            proc.redirect_failed = true;
+            proc.spawn_status = 1;
+            continue;
+        }
+        proc.path = find_in_path(*specs[i].name, ctx);
+        proc.found = access(proc.path.c_str(), F_OK) == 0;
+        if (!proc.found) {
+            report(
+                proc,
+                error,
+                "fluffy-tribble: " + *specs[i].name + ": command not found"
+            );
+            continue;
+        }
+        if (!specs[i].args->empty()) {
+            proc.argv_strings = *specs[i].args;
+        } else {
+            proc.argv_strings.push_back(proc.path);
+        }
+        proc.argv.reserve(proc.argv_strings.size() + 1);
+        for (auto &s : proc.argv_strings) {
+            proc.argv.push_back(s.data());
+        }
+        proc.argv.push_back(nullptr);
     }
-    envp.push_back(nullptr);
 
-    int input_fd = get_fd_from_stream(input);
-    int output_fd = get_fd_from_stream(output);
-    int error_fd = get_fd_from_stream(error);
+    const auto env_block = ctx.env_block();
+
+    int input_fd = stream_fd(input);
+    int output_fd = stream_fd(output);
+    int error_fd = stream_fd(error);
 
-    bool need_pipe_in = (input_fd == -1);
-    bool need_pipe_out = (output_fd == -1);
-    bool need_pipe_err = (error_fd == -1);
+    // Файлы перенаправлений передаются программам напрямую: канал и
+    // пересылка нужны только для потоков интерпретатора без дескриптора.
+    const bool all_err_files =
+        std::ranges::all_of(procs, [](const Process &proc) {
+            return proc.files[STDERR_FILENO] >= 0 || proc.redirect_failed;
+        });
+    bool need_pipe_in =
+        input_fd == -1 && procs.front().files[STDIN_FILENO] < 0;
+    bool need_pipe_out =
+        output_fd == -1 && procs.back().files[STDOUT_FILENO] < 0;
+    bool need_pipe_err = error_fd == -1 && !all_err_files;
 
     int pipe_in[2] = {-1, -1};
     int pipe_out[2] = {-1, -1};
     int pipe_err[2] = {-1, -1};
+    // Каналы между соседними программами: links[i] соединяет i и i + 1.
+    std::vector<std::array<int, 2>> links(procs.size() - 1, {-1, -1});
 
-    if (need_pipe_in && pipe(pipe_in) == -1) {
-        return -1;
-    }
-    if (need_pipe_out && pipe(pipe_out) == -1) {
-        if (need_pipe_in) {
-            close(pipe_in[0]);
-            close(pipe_in[1]);
+    const auto close_all = [&]() {
+        for (int *fds : {pipe_in, pipe_out, pipe_err}) {
+            close_fd(fds[0]);
+            close_fd(fds[1]);
         }
-        return -1;
-    }
-    if (need_pipe_err && pipe(pipe_err) == -1) {
-        if (need_pipe_in) {
-            close(pipe_in[0]);
-            close(pipe_in[1]);
+        for (Process &proc : procs) {
+            for (int &fd : proc.files) {
+                close_fd(fd);
+            }
         }
-        if (need_pipe_out) {
-            close(pipe_out[0]);
-            close(pipe_out[1]);
+        for (auto &link : links) {
+            close_fd(link[0]);
+            close_fd(link[1]);
         }
+    };
+
+    bool ok = (!need_pipe_in || make_pipe(pipe_in)) &&
+              (!need_pipe_out || make_pipe(pipe_out)) &&
+              (!need_pipe_err || make_pipe(pipe_err));
+    for (auto &link : links) {
+        ok = ok && make_pipe(link.data());
+    }
+    if (!ok) {
+        close_all();
         return -1;
     }
 
-    pid_t pid = fork();
-    if (pid < 0) {
-        if (need_pipe_in) {
-            close(pipe_in[0]);
-            close(pipe_in[1]);
+    // Дочерние процессы пишут в дескрипторы напрямую, поэтому накопленный в
+    // потоках вывод должен попасть туда раньше.
+    if (!need_pipe_out) {
+        output.flush();
+    }
+    if (!need_pipe_err) {
+        error.flush();
+    }
+
+    const int err_fd = need_pipe_err ? pipe_err[1] : error_fd;
+    for (std::size_t i = 0; i < procs.size(); ++i) {
+        Process &proc = procs[i];
+        if (i == 0) {
+            proc.in_fd = need_pipe_in ? pipe_in[0] : input_fd;
+        } else {
+            proc.in_fd = links[i - 1][0];
         }
-        if (need_pipe_out) {
-            close(pipe_out[0]);
-            close(pipe_out[1]);
+        if (i + 1 == procs.size()) {
+            proc.out_fd = need_pipe_out ? pipe_out[1] : output_fd;
+        } else {
+            proc.out_fd = links[i][1];
         }
-        if (need_pipe_err) {
-            close(pipe_err[0]);
-            close(pipe_err[1]);
+        proc.err_fd = err_fd;
+        if (proc.files[STDIN_FILENO] >= 0) {
+            proc.in_fd = proc.files[STDIN_FILENO];
         }
-        return -1;
-    }
-
-    if (pid == 0) {
-        if (need_pipe_in) {
-            dup2(pipe_in[0], STDIN_FILENO);
-            close(pipe_in[0]);
-            close(pipe_in[1]);
-        } else if (input_fd >= 0) {
-            dup2(input_fd, STDIN_FILENO);
+        if (proc.files[STDOUT_FILENO] >= 0) {
+            proc.out_fd = proc.files[STDOUT_FILENO];
         }
-
-        if (need_pipe_out) {
-            dup2(pipe_out[1], STDOUT_FILENO);
-            close(pipe_out[0]);
-            close(pipe_out[1]);
-        } else if (output_fd >= 0) {
-            dup2(output_fd, STDOUT_FILENO);
+        if (proc.files[STDERR_FILENO] >= 0) {
+            proc.err_fd = proc.files[STDERR_FILENO];
         }
-
-        if (need_pipe_err) {
-            dup2(pipe_err[1], STDERR_FILENO);
-            close(pipe_err[0]);
-            close(pipe_err[1]);
-        } else if (error_fd >= 0) {
-            dup2(error_fd, STDERR_FILENO);
+        if (!proc.found || proc.redirect_failed) {
+            continue;
         }
 
-        execve(path.c_str(), argv.data(), envp.data());
-
-        int err = errno;
-        std::error_code ec(err, std::system_category());
-        std::cerr << ec.message() << '\n';
-
-        if (err == ENOENT) {
-            _exit(127);
-        } else if (err == EACCES) {
-            _exit(126);
-        } else {
-            _exit(1);
+        int rc = 0;
+        {
+            TraceScope trace("process", "spawn", proc.path);
+            rc = spawn_child(proc, env_block->envp());
+        }
+        if (rc != 0) {
+            std::error_code ec(rc, std::system_category());
+            report(proc, error, ec.message());
+            proc.spawn_status = spawn_error_status(rc);
         }
     }
 
-    if (need_pipe_in) {
-        close(pipe_in[0]);
+    // Концы каналов, принадлежащие дочерним процессам, в родителе не нужны:
+    // иначе читатели не получат EOF.
+    close_fd(pipe_in[0]);
+    close_fd(pipe_out[1]);
+    close_fd(pipe_err[1]);
+    for (auto &link : links) {
+        close_fd(link[0]);
+        close_fd(link[1]);
     }
-    if (need_pipe_out) {
-        close(pipe_out[1]);
-    }
-    if (need_pipe_err) {
-        close(pipe_err[1]);
+    for (Process &proc : procs) {
+        for (int &fd : proc.files) {
+            close_fd(fd);
+        }
     }
 
-    std::thread writer;
-    std::thread reader_out;
-    std::thread reader_err;
-
-    if (need_pipe_in) {
-        writer = std::thread([&input, fd = pipe_in[1]]() {
-            write_stream_to_fd(input, fd);
-            close(fd);
-        });
+    if (need_pipe_in &&
+        (!procs.front().found || procs.front().redirect_failed)) {
+        close_fd(pipe_in[1]);
     }
-
-    if (need_pipe_out) {
-        reader_out = std::thread([&output, fd = pipe_out[0]]() {
-            read_fd_to_stream(fd, output);
-            close(fd);
-        });
+    RelayLoop relay(input, pipe_in[1], output, pipe_out[0], error, pipe_err[0]);
+    pipe_in[1] = -1;
+    pipe_out[0] = -1;
+    pipe_err[0] = -1;
+    for (Process &proc : procs) {
+        relay.watch(proc.child);
     }
-
-    if (need_pipe_err) {
-        reader_err = std::thread([&error, fd = pipe_err[0]]() {
-            read_fd_to_stream(fd, error);
-            close(fd);
-        });
+    {
+        TraceScope trace("process", "relay");
+        relay.run();
     }
 
-    int status = 0;
-    if (waitpid(pid, &status, 0) != pid) {
-        status = -1;
+    int result = -1;
+    for (Process &proc : procs) {
+        if (proc.redirect_failed) {
+            result = proc.spawn_status;
+            continue;
+        }
+        if (!proc.found) {
+            result = 127;
+            continue;
+        }
+        ChildExit &child = proc.child;
+        if (child.pid < 0) {
+            result = proc.spawn_status;
+            continue;
+        }
+        // Без pidfd (старое ядро) программа собирается здесь, блокирующе.
+        if (!child.reaped) {
+            child.reap(true);
+        }
+        if (!child.reaped) {
+            result = -1;
+            continue;
+        }
+        if (usage) {
+            usage->user_seconds += to_seconds(child.usage.ru_utime);
+            usage->sys_seconds += to_seconds(child.usage.ru_stime);
+        }
+        result = decode_status(child.status);
     }
 
-    if (writer.joinable()) {
-        writer.join();
-    }
-    if (reader_out.joinable()) {
-        reader_out.join();
-    }
-    if (reader_err.joinable()) {
-        reader_err.join();
-    }
+    close_all();
+    return result;
+}
 
-    if (need_pipe_in) {
-        close(pipe_in[1]);
-    }
-    if (need_pipe_out) {
-        close(pipe_out[0]);
-    }
-    if (need_pipe_err) {
-        close(pipe_err[0]);
-    }
+}  // namespace
 
-    if (WIFEXITED(status)) {
-        return WEXITSTATUS(status);
-    }
-    if (WIFSIGNALED(status)) {
-        return 128 + WTERMSIG(status);
+int ExternalRunner::run(
+    const std::string &name,
+    const std::vector<std::string> &args,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    ChildUsage *usage
+) {
+    return run_processes(
+        {ProcessSpec{.name = &name, .args = &args}},
+        input,
+        output,
+        error,
+        ctx,
+        usage
+    );
+}
+
+int ExternalRunner::run_chain(
+    std::span<const ParsedCommand> cmds,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    ChildUsage *usage
+) {
+    if (cmds.empty()) {
+        return 0;
+    }
+    std::vector<ProcessSpec> specs;
+    specs.reserve(cmds.size());
+    for (const ParsedCommand &cmd : cmds) {
+        specs.push_back(
+            ProcessSpec{
+                .name = &cmd.name,
+                .args = &cmd.args,
+                .redirects = &cmd.redirects,
+            }
+        );
     }
-    return -1;
+    return run_processes(specs, input, output, error, ctx, usage);
 }
 
-}  // namespace fluffy_tribble
\ No newline at end of file
+}  // namespace fluffy_tribble
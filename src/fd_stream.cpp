@@ -0,0 +1,218 @@
+#include "fd_stream.hpp"
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
+
+namespace fluffy_tribble {
+
+namespace {
+
+constexpr std::size_t kCopyChunk = 1024 * 1024;
+constexpr std::size_t kCopyBuffer = 128 * 1024;
+
+/**
+ * Ждёт готовности неблокирующего дескриптора после EAGAIN.
+ * @param events POLLIN или POLLOUT.
+ * @return false при ошибке poll.
+ */
+bool wait_ready(int fd, short events) {
+    pollfd pfd{.fd = fd, .events = events, .revents = 0};
+    while (poll(&pfd, 1, -1) == -1) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool write_all(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN && wait_ready(fd, POLLOUT)) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+#ifdef __linux__
+/**
+ * Выполняет перенос вызовом transfer из in_fd в out_fd до конца данных. Если
+ * неблокирующий дескриптор не готов (EAGAIN), ждёт в poll данных на входе и
+ * места на выходе, а не повторяет вызов сразу.
+ * @return 1 — всё скопировано, 0 — вызов не поддерживается для этой пары
+ * дескрипторов (ничего не скопировано этим способом), -1 — ошибка.
+ */
+template <typename Transfer>
+int kernel_copy(int in_fd, int out_fd, Transfer transfer) {
+    bool progressed = false;
+    while (true) {
+        ssize_t n = transfer();
+        if (n > 0) {
+            progressed = true;
+            continue;
+        }
+        if (n == 0) {
+            return 1;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN) {
+            if (!wait_ready(in_fd, POLLIN) || !wait_ready(out_fd, POLLOUT)) {
+                return -1;
+            }
+            continue;
+        }
+        if (!progressed && (errno == EINVAL || errno == EXDEV ||
+                            errno == ENOSYS || errno == EBADF ||
+                            errno == EOPNOTSUPP)) {
+            return 0;
+        }
+        return -1;
+    }
+}
+#endif
+
+}  // namespace
+
+FdStreamBuf::FdStreamBuf(int fd, bool owns, std::size_t buffer_size)
+    : fd_(fd), owns_(owns), buffer_(buffer_size) {}
+
+FdStreamBuf::~FdStreamBuf() {
+    flush_buffer();
+    if (owns_ && fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+int FdStreamBuf::fd() const {
+    return fd_;
+}
+
+FdStreamBuf::int_type FdStreamBuf::overflow(int_type ch) {
+    if (pbase() == nullptr) {
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    } else if (!flush_buffer()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize FdStreamBuf::xsputn(const char *s, std::streamsize n) {
+    // Крупные блоки пишутся напрямую, минуя буфер.
+    if (static_cast<std::size_t>(n) >= buffer_.size()) {
+        if (!flush_buffer() ||
+            !write_all(fd_, s, static_cast<std::size_t>(n))) {
+            return 0;
+        }
+        return n;
+    }
+    return std::streambuf::xsputn(s, n);
+}
+
+int FdStreamBuf::sync() {
+    return flush_buffer() ? 0 : -1;
+}
+
+FdStreamBuf::int_type FdStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    ssize_t n;
+    do {
+        n = read(fd_, buffer_.data(), buffer_.size());
+    } while (n == -1 && errno == EINTR);
+    if (n <= 0) {
+        return traits_type::eof();
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+bool FdStreamBuf::flush_buffer() {
+    if (pbase() == nullptr || pptr() == pbase()) {
+        return true;
+    }
+    const std::size_t n = pptr() - pbase();
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return write_all(fd_, buffer_.data(), n);
+}
+
+int stream_fd(const std::ios &stream) {
+    if (&stream == &std::cin) {
+        return STDIN_FILENO;
+    }
+    if (&stream == &std::cout) {
+        return STDOUT_FILENO;
+    }
+    if (&stream == &std::cerr) {
+        return STDERR_FILENO;
+    }
+    if (const auto *buf = dynamic_cast<const FdStreamBuf *>(stream.rdbuf())) {
+        return buf->fd();
+    }
+    return -1;
+}
+
+bool copy_fd(int in_fd, int out_fd) {
+#ifdef __linux__
+    const int copied = kernel_copy(in_fd, out_fd, [&] {
+        return copy_file_range(in_fd, nullptr, out_fd, nullptr, kCopyChunk, 0);
+    });
+    if (copied != 0) {
+        return copied > 0;
+    }
+    const int sent = kernel_copy(in_fd, out_fd, [&] {
+        return sendfile(out_fd, in_fd, nullptr, kCopyChunk);
+    });
+    if (sent != 0) {
+        return sent > 0;
+    }
+    const int spliced = kernel_copy(in_fd, out_fd, [&] {
+        return splice(in_fd, nullptr, out_fd, nullptr, kCopyChunk, 0);
+    });
+    if (spliced != 0) {
+        return spliced > 0;
+    }
+#endif
+    std::vector<char> buffer(kCopyBuffer);
+    while (true) {
+        ssize_t n = read(in_fd, buffer.data(), buffer.size());
+        if (n == 0) {
+            return true;
+        }
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN && wait_ready(in_fd, POLLIN)) {
+                continue;
+            }
+            return false;
+        }
+        if (!write_all(out_fd, buffer.data(), static_cast<std::size_t>(n))) {
+            return false;
+        }
+    }
+}
+
+}  // namespace fluffy_tribble
@@ -0,0 +1,190 @@
+#include "interpreter.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include "chrome_trace.hpp"
+#include "command_manager.hpp"
+#include "command_parser.hpp"
+#include "lexer.hpp"
+#include "list_executor.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+constexpr std::size_t kScriptBlock = 64 * 1024;
+
+/** Читает содержимое файла блоками; false при ошибке открытия или чтения. */
+bool read_file(const std::string &path, std::string &content) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    bool ok = true;
+    std::size_t size = 0;
+    while (true) {
+        content.resize(size + kScriptBlock);
+        ssize_t n = read(fd, content.data() + size, kScriptBlock);
+        if (n == 0) {
+            break;
+        }
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        size += static_cast<std::size_t>(n);
+    }
+    content.resize(size);
+    close(fd);
+    return ok;
+}
+
+}  // namespace
+
+Interpreter::Interpreter(
+    ExecutionContext &ctx,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error
+)
+    : ctx_(ctx), input_(input), output_(output), error_(error) {}
+
+bool Interpreter::execute_line(const std::string &line) {
+    TraceScope trace("interpreter", "line");
+    std::shared_ptr<const CommandList> list = cache_.find(line);
+    if (!list) {
+        list = parse_line(line);
+    }
+    if (!list) {
+        return true;
+    }
+
+    ListExecutor::execute(*list, input_, output_, error_, ctx_);
+    return !ctx_.is_exit();
+}
+
+CommandList Interpreter::parse_text(std::string_view line) {
+    Lexer lexer;
+    CommandParser parser;
+    try {
+        TokenViewStream tokens(arena_.resource());
+        {
+            TraceScope lex_trace("interpreter", "lex");
+            tokens = lexer.tokenize_views(line, arena_);
+        }
+        TraceScope parse_trace("interpreter", "parse");
+        CommandList list = parser.parse_list(tokens);
+        arena_.release();
+        return list;
+    } catch (const std::runtime_error &) {
+        arena_.release();
+        throw;
+    }
+}
+
+std::shared_ptr<const CommandList> Interpreter::parse_line(
+    const std::string &line
+) {
+    CommandList list;
+    try {
+        list = parse_text(line);
+    } catch (const std::runtime_error &e) {
+        error_ << "Error: " << e.what() << std::endl;
+        return nullptr;
+    }
+    if (list.empty()) {
+        return nullptr;
+    }
+    return cache_.insert(line, std::move(list));
+}
+
+int Interpreter::run_interactive(bool prompt) {
+    std::string line;
+    while (true) {
+        if (prompt) {
+            report_finished_jobs();
+            output_ << "$ " << std::flush;
+        }
+        if (!std::getline(input_, line)) {
+            break;
+        }
+        if (!execute_line(line)) {
+            break;
+        }
+    }
+    return exit_code();
+}
+
+std::vector<Interpreter::ScriptLine> Interpreter::parse_script(
+    std::string_view script
+) {
+    TraceScope trace("interpreter", "parse_script");
+    std::vector<ScriptLine> lines;
+    while (!script.empty()) {
+        std::size_t end = script.find('\n');
+        if (end == std::string_view::npos) {
+            end = script.size();
+        }
+        ScriptLine &line = lines.emplace_back();
+        line.text = script.substr(0, end);
+        script.remove_prefix(std::min(end + 1, script.size()));
+        try {
+            line.list = parse_text(line.text);
+        } catch (const std::runtime_error &e) {
+            line.error = e.what();
+        }
+    }
+    return lines;
+}
+
+int Interpreter::run_script(std::string_view script) {
+    const std::vector<ScriptLine> lines = parse_script(script);
+    const std::uint64_t generation = CommandManager::generation();
+    for (const ScriptLine &line : lines) {
+        if (CommandManager::generation() != generation) {
+            if (!execute_line(std::string(line.text))) {
+                break;
+            }
+            continue;
+        }
+        TraceScope trace("interpreter", "line");
+        if (!line.error.empty()) {
+            error_ << "Error: " << line.error << std::endl;
+            continue;
+        }
+        ListExecutor::execute(line.list, input_, output_, error_, ctx_);
+        if (ctx_.is_exit()) {
+            break;
+        }
+    }
+    return exit_code();
+}
+
+int Interpreter::run_file(const std::string &path) {
+    std::string script;
+    if (!read_file(path, script)) {
+        error_ << "fluffy-tribble: " << path << ": cannot open\n";
+        return 127;
+    }
+    return run_script(script);
+}
+
+void Interpreter::report_finished_jobs() {
+    for (const JobTable::JobInfo &job : ctx_.jobs().take_finished()) {
+        error_ << JobTable::describe(job) << '\n';
+    }
+}
+
+int Interpreter::exit_code() const {
+    return ctx_.is_exit() ? ctx_.exit_code() : 0;
+}
+
+}  // namespace fluffy_tribble
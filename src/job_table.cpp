@@ -0,0 +1,133 @@
+#include "job_table.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace fluffy_tribble {
+
+JobTable::~JobTable() {
+    for (auto &[id, job] : jobs_) {
+        if (job->thread.joinable()) {
+            job->thread.join();
+        }
+    }
+}
+
+int JobTable::start(std::string command, Body body, Reap reap) {
+    auto job = std::make_unique<Job>();
+    job->command = std::move(command);
+    job->reap = std::move(reap);
+    Job &ref = *job;
+
+    std::lock_guard lock(mutex_);
+    // Потоки завершённых заданий освобождаются сразу; их коды остаются.
+    for (auto &[id, done_job] : jobs_) {
+        if (done_job->done.load(std::memory_order_acquire) &&
+            done_job->thread.joinable()) {
+            done_job->thread.join();
+        }
+    }
+    ref.id = jobs_.empty() ? 1 : jobs_.rbegin()->first + 1;
+    ref.thread = std::thread([&ref, body = std::move(body)]() {
+        int status = 1;
+        try {
+            status = body();
+        } catch (...) {
+            status = 1;
+        }
+        ref.status = status;
+        ref.done.store(true, std::memory_order_release);
+    });
+    const int id = ref.id;
+    jobs_.emplace(id, std::move(job));
+    return id;
+}
+
+std::optional<int> JobTable::wait(int id) {
+    std::unique_ptr<Job> job;
+    {
+        std::lock_guard lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end()) {
+            return std::nullopt;
+        }
+        job = std::move(it->second);
+        jobs_.erase(it);
+    }
+    return finish(*job).status;
+}
+
+void JobTable::wait_all() {
+    std::map<int, std::unique_ptr<Job>> jobs;
+    {
+        std::lock_guard lock(mutex_);
+        jobs.swap(jobs_);
+    }
+    for (auto &[id, job] : jobs) {
+        finish(*job);
+    }
+}
+
+std::vector<JobTable::JobInfo> JobTable::list() {
+    std::vector<JobInfo> result;
+    for (const JobInfo &info : take_finished()) {
+        result.push_back(info);
+    }
+    std::lock_guard lock(mutex_);
+    for (const auto &[id, job] : jobs_) {
+        result.push_back(JobInfo{.id = id, .command = job->command});
+    }
+    std::ranges::sort(result, {}, &JobInfo::id);
+    return result;
+}
+
+std::vector<JobTable::JobInfo> JobTable::take_finished() {
+    std::vector<std::unique_ptr<Job>> finished;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto it = jobs_.begin(); it != jobs_.end();) {
+            if (it->second->done.load(std::memory_order_acquire)) {
+                finished.push_back(std::move(it->second));
+                it = jobs_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    std::vector<JobInfo> result;
+    result.reserve(finished.size());
+    for (auto &job : finished) {
+        result.push_back(finish(*job));
+    }
+    return result;
+}
+
+std::size_t JobTable::size() const {
+    std::lock_guard lock(mutex_);
+    return jobs_.size();
+}
+
+std::string JobTable::describe(const JobInfo &job) {
+    std::string state = "Running";
+    if (job.done) {
+        state = job.status == 0 ? "Done"
+                                : "Exit " + std::to_string(job.status);
+    }
+    return "[" + std::to_string(job.id) + "]  " + state + '\t' + job.command;
+}
+
+JobTable::JobInfo JobTable::finish(Job &job) {
+    if (job.thread.joinable()) {
+        job.thread.join();
+    }
+    if (job.reap) {
+        job.reap();
+    }
+    return JobInfo{
+        .id = job.id,
+        .command = job.command,
+        .done = true,
+        .status = job.status,
+    };
+}
+
+}  // namespace fluffy_tribble
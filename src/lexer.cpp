@@ -1,7 +1,17 @@
 #include "lexer.hpp"
 #include <cctype>
+#include <iostream>
+#include <memory>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
+#include "command_substitution.hpp"
+#include "expander.hpp"
+#include "lexer_scan.hpp"
 #include "token.hpp"
 
 namespace fluffy_tribble {
@@ -10,48 +20,232 @@ namespace {
 
 constexpr bool is_special_char(char c) {
     return c == ' ' || c == '|' || c == '$' || c == '"' || c == '\'' ||
-           c == '\\' || c == '=';
+           c == '\\' || c == '=' || c == '<' || c == '>' || c == '&' ||
+           c == ';';
+}
+
+/** Символ, после которого начинается новое слово (вне кавычек). */
+constexpr bool is_word_break(char c) {
+    return c == ' ' || c == '\t' || c == '|' || c == '<' || c == '>' ||
+           c == '&' || c == ';';
 }
 
 constexpr bool is_dq_escape(char c) {
     return c == '$' || c == '`' || c == '"' || c == '\\' || c == 'n';
 }
 
-void handle_escape(char c, bool in_double, std::string &word) {
+/**
+ * Слово, собираемое в собственную строку; подстановки выполняются сразу.
+ */
+class StringWord {
+public:
+    StringWord(const ExecutionContext &ctx, std::ostream &error)
+        : ctx_(ctx), error_(error) {}
+
+    void append(char c, std::size_t) { text_ += c; }
+
+    void append_text(std::string_view text) { text_ += text; }
+
+    void append_run(std::string_view run, std::size_t) { text_ += run; }
+
+    void add_expansion(ExpansionKind kind, std::string_view text) {
+        const Expansion expansion{
+            .kind = kind, .pos = 0, .text = std::string(text)
+        };
+        text_ += Expander::expand({}, {&expansion, 1}, ctx_, error_);
+    }
+
+    bool empty() const { return text_.empty(); }
+
+    bool equals(std::string_view text) const { return text_ == text; }
+
+    std::string take() {
+        std::string text = std::move(text_);
+        text_.clear();
+        return text;
+    }
+
+private:
+    const ExecutionContext &ctx_;
+    std::ostream &error_;
+    std::string text_;
+};
+
+/** Слово-представление, готовое стать токеном. */
+struct WordView {
+    std::string_view text;
+    std::span<const ExpansionView> expansions;
+};
+
+/**
+ * Слово-представление: пока символы берутся из входа подряд, слово остаётся
+ * участком входной строки; при первом разрыве или вставке текста оно
+ * копируется в буфер, а при завершении — в арену. Подстановки не
+ * выполняются, а запоминаются с позицией в тексте слова.
+ */
+class ViewWord {
+public:
+    ViewWord(std::string_view input, LineArena &arena)
+        : input_(input), arena_(arena) {}
+
+    void append(char c, std::size_t pos) {
+        if (state_ == State::EMPTY && pos < input_.size()) {
+            state_ = State::VIEW;
+            begin_ = pos;
+            end_ = pos + 1;
+            return;
+        }
+        if (state_ == State::VIEW && pos == end_) {
+            ++end_;
+            return;
+        }
+        to_copy();
+        copy_ += c;
+    }
+
+    void append_text(std::string_view text) {
+        if (text.empty()) {
+            return;
+        }
+        to_copy();
+        copy_ += text;
+    }
+
+    /** Добавляет участок входа run, начинающийся с позиции pos. */
+    void append_run(std::string_view run, std::size_t pos) {
+        if (state_ == State::EMPTY) {
+            state_ = State::VIEW;
+            begin_ = pos;
+            end_ = pos + run.size();
+            return;
+        }
+        if (state_ == State::VIEW && pos == end_) {
+            end_ += run.size();
+            return;
+        }
+        to_copy();
+        copy_ += run;
+    }
+
+    void add_expansion(ExpansionKind kind, std::string_view text) {
+        expansions_.push_back(
+            ExpansionView{.kind = kind, .pos = size(), .text = text}
+        );
+    }
+
+    bool empty() const {
+        return state_ == State::EMPTY && expansions_.empty();
+    }
+
+    bool equals(std::string_view text) const {
+        if (!expansions_.empty()) {
+            return false;
+        }
+        switch (state_) {
+            case State::VIEW:
+                return input_.substr(begin_, end_ - begin_) == text;
+            case State::COPY:
+                return copy_ == text;
+            default:
+                return text.empty();
+        }
+    }
+
+    WordView take() {
+        WordView word{
+            .text = state_ == State::VIEW ? input_.substr(begin_, end_ - begin_)
+                                          : arena_.store(copy_),
+            .expansions = {},
+        };
+        if (!expansions_.empty()) {
+            void *data = arena_.resource()->allocate(
+                expansions_.size() * sizeof(ExpansionView),
+                alignof(ExpansionView)
+            );
+            auto *stored = static_cast<ExpansionView *>(data);
+            std::uninitialized_copy(
+                expansions_.begin(), expansions_.end(), stored
+            );
+            word.expansions = std::span(stored, expansions_.size());
+            expansions_.clear();
+        }
+        state_ = State::EMPTY;
+        copy_.clear();
+        return word;
+    }
+
+private:
+    enum class State { EMPTY, VIEW, COPY };
+
+    std::size_t size() const {
+        switch (state_) {
+            case State::VIEW:
+                return end_ - begin_;
+            case State::COPY:
+                return copy_.size();
+            default:
+                return 0;
+        }
+    }
+
+    void to_copy() {
+        if (state_ == State::VIEW) {
+            copy_.assign(input_.substr(begin_, end_ - begin_));
+        }
+        state_ = State::COPY;
+    }
+
+    std::string_view input_;
+    LineArena &arena_;
+    State state_ = State::EMPTY;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    /** Буфер изменённого слова; переиспользуется между словами. */
+    std::string copy_;
+    /** Подстановки текущего слова. */
+    std::vector<ExpansionView> expansions_;
+};
+
+template <typename Word>
+void handle_escape(
+    std::string_view input,
+    std::size_t i,
+    bool in_double,
+    Word &word
+) {
+    const char c = i < input.size() ? input[i] : '\0';
     if (in_double) {
         if (is_dq_escape(c)) {
             if (c == 'n') {
-                word += '\n';
+                word.append_text("\n");
             } else {
-                word += c;
+                word.append(c, i);
             }
         } else {
-            word += '\\';
-            word += c;
+            word.append('\\', i - 1);
+            word.append(c, i);
         }
     } else {
-        word += c;
+        word.append(c, i);
     }
 }
 
+template <typename Word>
 std::size_t handle_dollar(
-    const std::string &input,
+    std::string_view input,
     std::size_t i,
     bool in_double,
-    std::string &word,
-    TokenStream &out,
-    ExecutionContext &ctx,
-    const auto &flush_word
+    Word &word,
+    const auto &flush_word,
+    const auto &emit
 ) {
     if (i + 1 < input.size() &&
         (std::isalnum(static_cast<unsigned char>(input[i + 1])) ||
          input[i + 1] == '_')) {
-        std::string var_name;
         std::size_t j = i + 1;
         while (j < input.size() &&
                (std::isalnum(static_cast<unsigned char>(input[j])) ||
                 input[j] == '_')) {
-            var_name += input[j];
             ++j;
         }
 
@@ -60,60 +254,113 @@ std::size_t handle_dollar(
 
         if (is_assignment) {
             flush_word();
-            out.push_back(Token{.type = TokenType::OP_DOLLAR, .value = "$"});
+            emit(TokenType::OP_DOLLAR, std::string_view("$"));
             return i;
         } else {
-            auto it = ctx.env().find(var_name);
-            if (it != ctx.env().end()) {
-                word += it->second;
-            }
+            word.add_expansion(
+                ExpansionKind::VARIABLE, input.substr(i + 1, j - i - 1)
+            );
             return j - 1;
         }
+    } else if (i + 1 < input.size() && input[i + 1] == '(') {
+        const std::size_t end = CommandSubstitution::find_end(input, i + 2);
+        if (end == std::string_view::npos) {
+            throw std::runtime_error("Unclosed command substitution");
+        }
+        word.add_expansion(
+            ExpansionKind::COMMAND, input.substr(i + 2, end - i - 2)
+        );
+        return end;
+    } else if (i + 1 < input.size() && input[i + 1] == '!') {
+        // $! — номер последнего фонового задания.
+        word.add_expansion(
+            ExpansionKind::VARIABLE, ExecutionContext::kLastJobVar
+        );
+        return i + 1;
     } else if (!in_double) {
         flush_word();
-        out.push_back(Token{.type = TokenType::OP_DOLLAR, .value = "$"});
+        emit(TokenType::OP_DOLLAR, std::string_view("$"));
     }
 
     return i;
 }
 
-}  // namespace
+/**
+ * Оператор перенаправления в позиции i: <, >, >>, а также 2> и 2>>, если
+ * перед > стоит отдельное слово из одной цифры 2 без кавычек.
+ * @return Позиция последнего символа оператора.
+ */
+template <typename Word>
+std::size_t handle_redirect(
+    std::string_view input,
+    std::size_t i,
+    Word &word,
+    const auto &flush_word,
+    const auto &emit
+) {
+    if (input[i] == '<') {
+        flush_word();
+        emit(TokenType::OP_REDIRECT, std::string_view("<"));
+        return i;
+    }
+    const bool append = i + 1 < input.size() && input[i + 1] == '>';
+    const bool error_stream = i > 0 && input[i - 1] == '2' &&
+                              word.equals("2") &&
+                              (i == 1 || is_word_break(input[i - 2]));
+    if (error_stream) {
+        word.take();
+    } else {
+        flush_word();
+    }
+    std::string_view op = append ? ">>" : ">";
+    if (error_stream) {
+        op = append ? "2>>" : "2>";
+    }
+    emit(TokenType::OP_REDIRECT, op);
+    return append ? i + 1 : i;
+}
 
-TokenStream Lexer::tokenize(const std::string &input, ExecutionContext &ctx) {
-    TokenStream out;
-    std::string word;
+/**
+ * Общий разбор строки: слова собираются в Word, готовые токены передаются
+ * в emit(тип, значение).
+ */
+template <typename Word, typename Emit>
+void lex(std::string_view input, Word &word, const Emit &emit) {
     bool in_single = false;
     bool in_double = false;
     bool escaping = false;
 
-    const auto flush_word = [&out, &word]() {
+    const auto flush_word = [&emit, &word]() {
         if (!word.empty()) {
-            out.push_back(
-                Token{.type = TokenType::WORD, .value = std::move(word)}
-            );
-            word.clear();
+            emit(TokenType::WORD, word.take());
         }
     };
 
     for (std::size_t i = 0; i <= input.size(); ++i) {
-        const char c = (i < input.size()) ? input[i] : '\0';
-
         if (escaping) {
-            handle_escape(c, in_double, word);
+            handle_escape(input, i, in_double, word);
             escaping = false;
             continue;
         }
 
+        // Простые байты добавляются к слову одним участком.
+        const std::size_t plain_end = scan_plain(input, i);
+        if (plain_end > i) {
+            word.append_run(input.substr(i, plain_end - i), i);
+            i = plain_end;
+        }
+        const char c = (i < input.size()) ? input[i] : '\0';
+
         if (c == '\\') {
             if (in_single) {
-                word += c;
+                word.append(c, i);
             } else if (in_double) {
                 escaping = true;
             } else {
                 if (i + 1 < input.size() && is_special_char(input[i + 1])) {
                     escaping = true;
                 } else {
-                    word += c;
+                    word.append(c, i);
                 }
             }
             continue;
@@ -130,19 +377,41 @@ TokenStream Lexer::tokenize(const std::string &input, ExecutionContext &ctx) {
         }
 
         if (c == '$' && !in_single) {
-            i = handle_dollar(input, i, in_double, word, out, ctx, flush_word);
+            i = handle_dollar(input, i, in_double, word, flush_word, emit);
+            continue;
+        }
+
+        if ((c == '|' || c == '&') && !in_single && !in_double) {
+            flush_word();
+            if (i + 1 < input.size() && input[i + 1] == c) {
+                if (c == '|') {
+                    emit(TokenType::OP_OR, std::string_view("||"));
+                } else {
+                    emit(TokenType::OP_AND, std::string_view("&&"));
+                }
+                ++i;
+            } else if (c == '|') {
+                emit(TokenType::OP_PIPE, std::string_view("|"));
+            } else {
+                emit(TokenType::OP_BACKGROUND, std::string_view("&"));
+            }
             continue;
         }
 
-        if (c == '|' && !in_single && !in_double) {
+        if (c == ';' && !in_single && !in_double) {
             flush_word();
-            out.push_back(Token{.type = TokenType::OP_PIPE, .value = "|"});
+            emit(TokenType::OP_SEQUENCE, std::string_view(";"));
+            continue;
+        }
+
+        if ((c == '<' || c == '>') && !in_single && !in_double) {
+            i = handle_redirect(input, i, word, flush_word, emit);
             continue;
         }
 
         if (c == '=' && !in_single && !in_double) {
             flush_word();
-            out.push_back(Token{.type = TokenType::OP_ASSIGN, .value = "="});
+            emit(TokenType::OP_ASSIGN, std::string_view("="));
             continue;
         }
 
@@ -157,7 +426,7 @@ TokenStream Lexer::tokenize(const std::string &input, ExecutionContext &ctx) {
             break;
         }
 
-        word += c;
+        word.append(c, i);
     }
 
     if (in_single) {
@@ -167,8 +436,55 @@ TokenStream Lexer::tokenize(const std::string &input, ExecutionContext &ctx) {
         throw std::runtime_error("Unclosed double quote");
     }
 
-    out.push_back(Token{.type = TokenType::EOF_, .value = ""});
+    emit(TokenType::EOF_, std::string_view());
+}
+
+}  // namespace
 
+TokenStream Lexer::tokenize(
+    const std::string &input,
+    ExecutionContext &ctx,
+    std::ostream &error
+) {
+    TokenStream out;
+    StringWord word(ctx, error);
+    lex(input, word, [&out](TokenType type, auto &&value) {
+        out.push_back(
+            Token{
+                .type = type,
+                .value = std::string(std::forward<decltype(value)>(value))
+            }
+        );
+    });
+    return out;
+}
+
+TokenStream Lexer::tokenize(const std::string &input, ExecutionContext &ctx) {
+    return tokenize(input, ctx, std::cerr);
+}
+
+TokenViewStream Lexer::tokenize_views(
+    std::string_view input,
+    LineArena &arena
+) {
+    TokenViewStream out(arena.resource());
+    ViewWord word(input, arena);
+    const auto emit = [&out](TokenType type, const auto &value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, WordView>) {
+            out.push_back(
+                TokenView{
+                    .type = type,
+                    .value = value.text,
+                    .expansions = value.expansions,
+                }
+            );
+        } else {
+            out.push_back(
+                TokenView{.type = type, .value = value, .expansions = {}}
+            );
+        }
+    };
+    lex(input, word, emit);
     return out;
 }
 
@@ -0,0 +1,68 @@
+#include "lexer_scan.hpp"
+#include <array>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FLUFFY_TRIBBLE_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace fluffy_tribble {
+
+namespace {
+
+constexpr std::array<bool, 256> kSpecial = [] {
+    std::array<bool, 256> table{};
+    for (unsigned char c :
+         {'\\', '\'', '"', '$', '|', '=', '<', '>', '&', ';', ' ', '\0'}) {
+        table[c] = true;
+    }
+    for (unsigned char c = '\t'; c <= '\r'; ++c) {
+        table[c] = true;
+    }
+    return table;
+}();
+
+#ifdef FLUFFY_TRIBBLE_SCAN_SSE2
+/** Маска особых байтов в 16 байтах. */
+unsigned special_mask(__m128i v) {
+    __m128i hit = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    for (char c : {'\'', '"', '$', '|', '=', '<', '>', '&', ';', ' ', '\0'}) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+    }
+    // Байты 9..13: (v - 9) как беззнаковое не больше 4.
+    const __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    const __m128i in_range = _mm_cmpeq_epi8(
+        _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted
+    );
+    const __m128i special = _mm_or_si128(hit, in_range);
+    return static_cast<unsigned>(_mm_movemask_epi8(special));
+}
+#endif
+
+}  // namespace
+
+std::size_t scan_plain(std::string_view input, std::size_t pos) {
+#ifdef FLUFFY_TRIBBLE_SCAN_SSE2
+    const char *data = input.data();
+    while (pos + 16 <= input.size()) {
+        const __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        const unsigned mask = special_mask(v);
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        pos += 16;
+    }
+#endif
+    return scan_plain_scalar(input, pos);
+}
+
+std::size_t scan_plain_scalar(std::string_view input, std::size_t pos) {
+    while (pos < input.size() &&
+           !kSpecial[static_cast<unsigned char>(input[pos])]) {
+        ++pos;
+    }
+    return pos;
+}
+
+}  // namespace fluffy_tribble
@@ -0,0 +1,31 @@
+#include "line_arena.hpp"
+#include <cstring>
+
+namespace fluffy_tribble {
+
+LineArena::LineArena()
+    : inline_{},
+      resource_(
+          inline_.data(),
+          inline_.size(),
+          std::pmr::new_delete_resource()
+      ) {}
+
+std::string_view LineArena::store(std::string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    auto *data = static_cast<char *>(resource_.allocate(text.size(), 1));
+    std::memcpy(data, text.data(), text.size());
+    return {data, text.size()};
+}
+
+std::pmr::memory_resource *LineArena::resource() {
+    return &resource_;
+}
+
+void LineArena::release() {
+    resource_.release();
+}
+
+}  // namespace fluffy_tribble
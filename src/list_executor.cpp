@@ -0,0 +1,207 @@
+#include "list_executor.hpp"
+#include <exception>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "expander.hpp"
+#include "fd_stream.hpp"
+#include "pipe_executor.hpp"
+#include "stage_stats.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+/**
+ * Поток вывода фонового задания: поверх дескриптора исходного потока или,
+ * если его нет, в память.
+ */
+class JobOutput {
+public:
+    explicit JobOutput(std::ostream &target) : target_(target) {
+        const int fd = stream_fd(target);
+        if (fd >= 0) {
+            fd_buf_.emplace(fd, false);
+            stream_.rdbuf(&*fd_buf_);
+        } else {
+            stream_.rdbuf(captured_.rdbuf());
+        }
+    }
+
+    std::ostream &stream() { return stream_; }
+
+    /** Переносит накопленный в памяти вывод в исходный поток. */
+    void deliver() {
+        if (!fd_buf_) {
+            target_ << captured_.str();
+            captured_.str({});
+        }
+    }
+
+private:
+    std::ostream &target_;
+    std::optional<FdStreamBuf> fd_buf_;
+    std::ostringstream captured_;
+    std::ostream stream_{nullptr};
+};
+
+/** Всё, чем владеет фоновое задание. */
+struct JobState {
+    JobState(
+        std::span<const ListItem> chain,
+        std::ostream &output,
+        std::ostream &error,
+        const ExecutionContext &parent
+    )
+        : chain(chain.begin(), chain.end()),
+          ctx(parent),
+          output(output),
+          error(error) {}
+
+    CommandList chain;
+    ExecutionContext ctx;
+    std::istringstream input;
+    JobOutput output;
+    JobOutput error;
+};
+
+bool is_conditional(ListOp op) {
+    return op == ListOp::AND || op == ListOp::OR;
+}
+
+/** Текст цепочки для jobs: пайплайны с операторами && и || между ними. */
+std::string describe_chain(std::span<const ListItem> chain) {
+    std::string text;
+    for (const ListItem &item : chain) {
+        text += describe_commands(item.pipe);
+        if (item.op == ListOp::AND) {
+            text += " && ";
+        } else if (item.op == ListOp::OR) {
+            text += " || ";
+        }
+    }
+    return text;
+}
+
+/**
+ * Выполняет пайплайн, сначала выполнив подстановки в его словах по
+ * текущему контексту. Ошибка подстановки завершает пайплайн с кодом 1.
+ */
+void run_pipe(
+    const Pipe &pipe,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx
+) {
+    if (!Expander::needs_expansion(pipe)) {
+        PipeExecutor::execute(pipe, input, output, error, ctx);
+        return;
+    }
+    Pipe expanded;
+    try {
+        expanded = Expander::expand(pipe, ctx, error);
+    } catch (const std::runtime_error &e) {
+        error << "fluffy-tribble: " << e.what() << '\n';
+        ctx.set_last_status(1);
+        return;
+    }
+    PipeExecutor::execute(expanded, input, output, error, ctx);
+}
+
+/**
+ * Выполняет цепочку пайплайнов, связанных && и ||: пайплайн пропускается,
+ * если код возврата предыдущего выполненного не подходит к оператору
+ * перед ним. Оператор после последнего пайплайна не учитывается.
+ */
+void run_chain(
+    std::span<const ListItem> chain,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx
+) {
+    bool run = true;
+    for (const ListItem &item : chain) {
+        if (ctx.is_exit()) {
+            break;
+        }
+        if (run) {
+            run_pipe(item.pipe, input, output, error, ctx);
+        }
+        if (item.op == ListOp::AND) {
+            run = ctx.last_status() == 0;
+        } else if (item.op == ListOp::OR) {
+            run = ctx.last_status() != 0;
+        }
+    }
+}
+
+}  // namespace
+
+void ListExecutor::execute(
+    const CommandList &list,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx
+) {
+    std::size_t begin = 0;
+    while (begin < list.size() && !ctx.is_exit()) {
+        // Цепочка && и || до ; или & выполняется (или уходит в фон) целиком.
+        std::size_t last = begin;
+        while (last + 1 < list.size() && is_conditional(list[last].op)) {
+            ++last;
+        }
+        const auto chain = std::span(list).subspan(begin, last - begin + 1);
+        if (list[last].op == ListOp::BACKGROUND) {
+            start_job(chain, output, error, ctx);
+        } else {
+            run_chain(chain, input, output, error, ctx);
+        }
+        begin = last + 1;
+    }
+}
+
+int ListExecutor::start_job(
+    std::span<const ListItem> chain,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx
+) {
+    // Вывод, сделанный до запуска, должен оказаться раньше вывода задания.
+    output.flush();
+    error.flush();
+
+    auto state = std::make_shared<JobState>(chain, output, error, ctx);
+    const int id = ctx.jobs().start(
+        describe_chain(chain) + " &",
+        [state]() {
+            std::ostream &out = state->output.stream();
+            std::ostream &err = state->error.stream();
+            try {
+                run_chain(state->chain, state->input, out, err, state->ctx);
+            } catch (const std::exception &e) {
+                err << "fluffy-tribble: " << e.what() << '\n';
+                state->ctx.set_last_status(1);
+            }
+            out.flush();
+            err.flush();
+            return state->ctx.is_exit() ? state->ctx.exit_code()
+                                        : state->ctx.last_status();
+        },
+        [state]() {
+            state->output.deliver();
+            state->error.deliver();
+        }
+    );
+    ctx.set_env(std::string(ExecutionContext::kLastJobVar), std::to_string(id));
+    return id;
+}
+
+}  // namespace fluffy_tribble
@@ -1,46 +1,57 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <stdexcept>
 #include <string>
-#include "command_executor.hpp"
-#include "command_parser.hpp"
+#include "chrome_trace.hpp"
 #include "execution_context.hpp"
-#include "lexer.hpp"
-#include "pipe_executor.hpp"
+#include "interpreter.hpp"
 
-int main() {
-    fluffy_tribble::ExecutionContext ctx;
-
-    while (true) {
-        std::cout << "$ " << std::flush;
-        std::string line;
-        if (!std::getline(std::cin, line)) {
-            break;
-        }
+namespace {
 
-        fluffy_tribble::Lexer lexer;
-        fluffy_tribble::TokenStream tokens;
-        try {
-            tokens = lexer.tokenize(line, ctx);
-        } catch (const std::runtime_error &e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            continue;
-        }
+/** Буфер stdout в пакетном режиме: вывод не сбрасывается после строки. */
+constexpr std::size_t kBatchOutputBuffer = 1024 * 1024;
 
-        fluffy_tribble::CommandParser parser;
-        fluffy_tribble::Pipe pipe = parser.parse(tokens);
+void use_batch_output() {
+    std::setvbuf(stdout, nullptr, _IOFBF, kBatchOutputBuffer);
+}
 
-        if (pipe.empty()) {
-            continue;
+int run(int argc, char *argv[]) {
+    fluffy_tribble::ExecutionContext ctx;
+    fluffy_tribble::Interpreter interpreter(
+        ctx, std::cin, std::cout, std::cerr
+    );
+
+    if (argc > 1) {
+        const std::string first = argv[1];
+        if (first == "-c") {
+            if (argc < 3) {
+                std::cerr
+                    << "fluffy-tribble: -c: option requires an argument\n";
+                return 2;
+            }
+            use_batch_output();
+            return interpreter.run_script(argv[2]);
         }
+        use_batch_output();
+        return interpreter.run_file(first);
+    }
 
-        fluffy_tribble::PipeExecutor::execute(
-            pipe, std::cin, std::cout, std::cerr, ctx
-        );
+    // Приглашение выводится, только если ввод идёт с терминала.
+    return interpreter.run_interactive(isatty(STDIN_FILENO) != 0);
+}
 
-        if (ctx.is_exit()) {
-            return ctx.exit_code();
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    using fluffy_tribble::ChromeTrace;
+    if (const char *path = std::getenv(fluffy_tribble::kChromeTraceEnv)) {
+        if (*path != '\0' && !ChromeTrace::start(path)) {
+            std::cerr << "fluffy-tribble: " << path
+                      << ": cannot open trace file\n";
         }
     }
-
-    return 0;
-}
\ No newline at end of file
+    const int code = run(argc, argv);
+    ChromeTrace::stop();
+    return code;
+}
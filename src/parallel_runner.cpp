@@ -0,0 +1,278 @@
+#include "parallel_runner.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "command_executor.hpp"
+#include "command_manager.hpp"
+#include "fd_stream.hpp"
+#include "parsed_command.hpp"
+#include "spill_buffer.hpp"
+#include "stream_channel.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+/** Команда шаблона для строки item. */
+ParsedCommand make_command(
+    const std::vector<std::string> &command,
+    const std::string &item
+) {
+    bool substituted = false;
+    std::vector<std::string> words;
+    words.reserve(command.size() + 1);
+    for (const std::string &word : command) {
+        std::string &out = words.emplace_back();
+        for (std::size_t pos = 0;;) {
+            const std::size_t mark = word.find("{}", pos);
+            out.append(word, pos, mark - pos);
+            if (mark == std::string::npos) {
+                break;
+            }
+            out.append(item);
+            substituted = true;
+            pos = mark + 2;
+        }
+    }
+    if (!substituted) {
+        words.push_back(item);
+    }
+
+    ParsedCommand cmd;
+    cmd.name = words.front();
+    cmd.id = CommandManager::get_command_id(cmd.name);
+    const auto first_arg =
+        cmd.id == CommandID::EXTERNAL ? words.begin() : words.begin() + 1;
+    cmd.args.assign(
+        std::make_move_iterator(first_arg), std::make_move_iterator(words.end())
+    );
+    return cmd;
+}
+
+/** Строка входа, взятая в работу. */
+struct Task {
+    std::size_t index;
+    std::string item;
+};
+
+/** Выполнение одного вызова parallel. */
+class ParallelRun {
+public:
+    ParallelRun(
+        const ParallelRunner::Options &options,
+        std::ostream &output,
+        std::ostream &error,
+        ExecutionContext &ctx
+    )
+        : options_(options),
+          output_(output),
+          error_(error),
+          ctx_(ctx),
+          temp_dir_(SpillBuffer::temp_dir(ctx)) {
+        jobs_ = options.jobs != 0
+                    ? options.jobs
+                    : std::max(1U, std::thread::hardware_concurrency());
+        jobs_ = std::min(jobs_, ParallelRunner::kMaxJobs);
+        window_ = options.window != 0 ? options.window : 2 * jobs_;
+        window_ = std::max(window_, jobs_);
+    }
+
+    int run(std::istream &input) {
+        std::vector<std::thread> workers;
+        workers.reserve(jobs_);
+
+        std::string line;
+        std::size_t index = 0;
+        while (std::getline(input, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            {
+                std::unique_lock lock(mutex_);
+                has_room_.wait(lock, [this] { return in_flight_ < window_; });
+                ++in_flight_;
+                tasks_.push_back(
+                    Task{.index = index++, .item = std::move(line)}
+                );
+                has_task_.notify_one();
+            }
+            if (workers.size() < jobs_) {
+                workers.emplace_back(&ParallelRun::work, this);
+            }
+        }
+        {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+        }
+        has_task_.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        return static_cast<int>(
+            std::min<std::size_t>(failed_, ParallelRunner::kMaxStatus)
+        );
+    }
+
+private:
+    /** Завершённая команда, ожидающая вывода. */
+    struct Result {
+        std::unique_ptr<SpillBuffer> output;
+        int status = 0;
+    };
+
+    void work() {
+        // Поток ошибок с дескриптором каждый исполнитель пишет напрямую,
+        // иначе — под общим мьютексом.
+        const int error_fd = stream_fd(error_);
+        std::optional<FdStreamBuf> error_fd_buf;
+        std::optional<SharedWriteBuf> error_shared_buf;
+        std::ostream err(nullptr);
+        if (error_fd >= 0) {
+            err.rdbuf(&error_fd_buf.emplace(error_fd, false));
+        } else {
+            err.rdbuf(&error_shared_buf.emplace(error_, error_mutex_));
+        }
+
+        while (std::optional<Task> task = next_task()) {
+            auto buffer = std::make_unique<SpillBuffer>(
+                ParallelRunner::kJobMemory, temp_dir_
+            );
+            std::ostream out(buffer.get());
+            std::istringstream in;
+            int status = 1;
+            try {
+                status = CommandExecutor::run(
+                    make_command(options_.command, task->item),
+                    in,
+                    out,
+                    err,
+                    ctx_
+                );
+            } catch (const std::exception &e) {
+                err << "parallel: " << e.what() << '\n';
+            }
+            out.flush();
+            err.flush();
+            complete(
+                task->index,
+                Result{.output = std::move(buffer), .status = status}
+            );
+        }
+    }
+
+    std::optional<Task> next_task() {
+        std::unique_lock lock(mutex_);
+        has_task_.wait(lock, [this] { return !tasks_.empty() || closed_; });
+        if (tasks_.empty()) {
+            return std::nullopt;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        return task;
+    }
+
+    /**
+     * Ставит результат в очередь вывода. Выводит один поток за раз: пока
+     * он пишет, другие только добавляют свои результаты, и он забирает их
+     * следующими — порядок вывода сохраняется без удержания мьютекса на
+     * время записи.
+     */
+    void complete(std::size_t index, Result result) {
+        std::unique_lock lock(mutex_);
+        if (result.status != 0) {
+            ++failed_;
+        }
+        ready_.emplace(index, std::move(result));
+        if (writing_) {
+            return;
+        }
+        writing_ = true;
+        while (true) {
+            std::vector<Result> batch;
+            for (auto it = ready_.begin(); it != ready_.end();) {
+                if (options_.keep_order && it->first != next_output_) {
+                    break;
+                }
+                batch.push_back(std::move(it->second));
+                it = ready_.erase(it);
+                ++next_output_;
+            }
+            if (batch.empty()) {
+                break;
+            }
+            lock.unlock();
+            for (Result &done : batch) {
+                write(*done.output);
+            }
+            lock.lock();
+            in_flight_ -= batch.size();
+            has_room_.notify_one();
+        }
+        writing_ = false;
+    }
+
+    void write(SpillBuffer &buffer) {
+        if (buffer.failed()) {
+            std::lock_guard lock(error_mutex_);
+            error_ << "parallel: cannot write output buffer to " << temp_dir_
+                   << '\n';
+        }
+        if (buffer.size() == 0) {
+            return;
+        }
+        buffer.rewind();
+        output_ << &buffer;
+    }
+
+    const ParallelRunner::Options &options_;
+    std::ostream &output_;
+    std::ostream &error_;
+    ExecutionContext &ctx_;
+    std::string temp_dir_;
+    std::size_t jobs_ = 1;
+    std::size_t window_ = 1;
+
+    std::mutex mutex_;
+    std::condition_variable has_task_;
+    std::condition_variable has_room_;
+    std::deque<Task> tasks_;
+    bool closed_ = false;
+    /** Взятые строки, ещё не выведенные. */
+    std::size_t in_flight_ = 0;
+    /** Готовые результаты по номеру строки. */
+    std::map<std::size_t, Result> ready_;
+    std::size_t next_output_ = 0;
+    bool writing_ = false;
+    std::size_t failed_ = 0;
+    std::mutex error_mutex_;
+};
+
+}  // namespace
+
+int ParallelRunner::run(
+    const Options &options,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx
+) {
+    if (options.command.empty()) {
+        return 0;
+    }
+    ParallelRun run(options, output, error, ctx);
+    return run.run(input);
+}
+
+}  // namespace fluffy_tribble
@@ -0,0 +1,117 @@
+#include "path_cache.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <system_error>
+
+namespace fluffy_tribble {
+
+namespace {
+
+std::filesystem::file_time_type dir_mtime(const std::string &dir) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(dir, ec);
+    return ec ? std::filesystem::file_time_type::min() : t;
+}
+
+}  // namespace
+
+std::string PathCache::resolve(
+    const std::string &name,
+    const std::string &path_env
+) {
+    if (name.find('/') != std::string::npos) {
+        return name;
+    }
+    std::lock_guard lock(mutex_);
+    Cached *cached = lookup(name, path_env);
+    if (!cached) {
+        return name;
+    }
+    ++cached->hits;
+    return cached->path;
+}
+
+bool PathCache::remember(const std::string &name, const std::string &path_env) {
+    if (name.find('/') != std::string::npos) {
+        return false;
+    }
+    std::lock_guard lock(mutex_);
+    return lookup(name, path_env) != nullptr;
+}
+
+void PathCache::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    path_env_.clear();
+    dirs_.clear();
+}
+
+std::vector<PathCache::Entry> PathCache::entries() const {
+    std::vector<Entry> out;
+    {
+        std::lock_guard lock(mutex_);
+        out.reserve(entries_.size());
+        for (const auto &[name, cached] : entries_) {
+            out.push_back(
+                Entry{.name = name, .path = cached.path, .hits = cached.hits}
+            );
+        }
+    }
+    std::ranges::sort(out, {}, &Entry::name);
+    return out;
+}
+
+PathCache::Cached *PathCache::lookup(
+    const std::string &name,
+    const std::string &path_env
+) {
+    // Кэш мог быть построен для другого значения PATH.
+    if (path_env != path_env_ || dirs_.empty()) {
+        reset_dirs(path_env);
+    }
+
+    auto it = entries_.find(name);
+    if (it != entries_.end()) {
+        const auto &mtimes = it->second.mtimes;
+        bool valid = true;
+        for (std::size_t i = 0; i < mtimes.size() && valid; ++i) {
+            valid = dir_mtime(dirs_[i]) == mtimes[i];
+        }
+        if (valid) {
+            return &it->second;
+        }
+        entries_.erase(it);
+    }
+
+    Cached cached;
+    std::string candidate;
+    for (const std::string &dir : dirs_) {
+        cached.mtimes.push_back(dir_mtime(dir));
+        candidate.assign(dir).append("/").append(name);
+        if (access(candidate.c_str(), X_OK) == 0) {
+            cached.path = candidate;
+            return &entries_.insert_or_assign(name, std::move(cached))
+                        .first->second;
+        }
+    }
+    return nullptr;
+}
+
+void PathCache::reset_dirs(const std::string &path_env) {
+    entries_.clear();
+    dirs_.clear();
+    path_env_ = path_env;
+    std::size_t begin = 0;
+    while (begin <= path_env.size()) {
+        std::size_t end = path_env.find(':', begin);
+        if (end == std::string::npos) {
+            end = path_env.size();
+        }
+        if (end > begin) {
+            dirs_.push_back(path_env.substr(begin, end - begin));
+        }
+        begin = end + 1;
+    }
+}
+
+}  // namespace fluffy_tribble
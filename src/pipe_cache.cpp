@@ -0,0 +1,57 @@
+#include "pipe_cache.hpp"
+#include <algorithm>
+#include <utility>
+#include "command_manager.hpp"
+
+namespace fluffy_tribble {
+
+PipeCache::PipeCache(std::size_t capacity)
+    : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+std::shared_ptr<const CommandList> PipeCache::find(std::string_view line) {
+    auto it = index_.find(line);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    Entry &entry = *it->second;
+    if (entry.commands_generation != CommandManager::generation()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return entry.list;
+}
+
+std::shared_ptr<const CommandList> PipeCache::insert(
+    std::string_view line,
+    CommandList list
+) {
+    if (auto it = index_.find(line); it != index_.end()) {
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+    if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().line);
+        entries_.pop_back();
+    }
+
+    entries_.push_front(
+        Entry{
+            .line = std::string(line),
+            .list = std::make_shared<const CommandList>(std::move(list)),
+            .commands_generation = CommandManager::generation(),
+        }
+    );
+    index_.emplace(entries_.front().line, entries_.begin());
+    return entries_.front().list;
+}
+
+void PipeCache::clear() {
+    index_.clear();
+    entries_.clear();
+}
+
+std::size_t PipeCache::size() const {
+    return entries_.size();
+}
+
+}  // namespace fluffy_tribble
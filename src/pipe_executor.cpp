@@ -1,45 +1,339 @@
 #include "pipe_executor.hpp"
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include "chrome_trace.hpp"
 #include "command_executor.hpp"
+#include "external_runner.hpp"
+#include "spill_buffer.hpp"
+#include "stream_channel.hpp"
 
 namespace fluffy_tribble {
 
+namespace {
+
+PipeMode mode_from_env(const ExecutionContext &ctx) {
+    auto it = ctx.env().find(PipeExecutor::kModeEnv);
+    if (it != ctx.env().end() && it->second == "sequential") {
+        return PipeMode::SEQUENTIAL;
+    }
+    return PipeMode::STREAMING;
+}
+
+/** Предел памяти буфера между стадиями (в байтах) из kBufferEnv. */
+std::size_t buffer_limit(const ExecutionContext &ctx) {
+    std::size_t mib = PipeExecutor::kDefaultBufferMiB;
+    auto it = ctx.env().find(PipeExecutor::kBufferEnv);
+    if (it != ctx.env().end()) {
+        const std::string &value = it->second;
+        std::size_t parsed = 0;
+        auto [end, ec] =
+            std::from_chars(value.data(), value.data() + value.size(), parsed);
+        if (ec == std::errc() && end == value.data() + value.size() &&
+            parsed <= std::numeric_limits<std::size_t>::max() >> 20) {
+            mib = parsed;
+        }
+    }
+    return mib << 20;
+}
+
+bool mutates_context(const Pipe &pipe) {
+    for (const ParsedCommand &cmd : pipe) {
+        if (cmd.id == CommandID::ASSIGN || cmd.id == CommandID::EXIT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Стадия пайплайна: одна команда или цепочка внешних программ. */
+using Stage = std::span<const ParsedCommand>;
+
+/**
+ * Объединяет подряд идущие внешние команды в одну стадию: они соединяются
+ * каналами pipe(2) напрямую, без копирования данных через интерпретатор.
+ */
+std::vector<Stage> split_stages(const Pipe &pipe) {
+    std::vector<Stage> stages;
+    std::size_t begin = 0;
+    while (begin < pipe.size()) {
+        std::size_t end = begin + 1;
+        if (pipe[begin].id == CommandID::EXTERNAL) {
+            while (end < pipe.size() && pipe[end].id == CommandID::EXTERNAL) {
+                ++end;
+            }
+        }
+        stages.emplace_back(pipe.data() + begin, end - begin);
+        begin = end;
+    }
+    return stages;
+}
+
+int run_stage(
+    Stage stage,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    StageStats *stats
+) {
+    if (stage.size() == 1) {
+        return CommandExecutor::run(stage[0], input, output, error, ctx, stats);
+    }
+    if (!stats) {
+        return ExternalRunner::run_chain(stage, input, output, error, ctx);
+    }
+    stats->command = describe_commands(stage);
+    StageMeter meter(*stats, input, output);
+    int status = ExternalRunner::run_chain(
+        stage, meter.input(), meter.output(), error, ctx, &meter.children()
+    );
+    meter.finish(status);
+    return status;
+}
+
+StageStats *stage_stats(std::vector<StageStats> *stats, std::size_t i) {
+    return stats ? &(*stats)[i] : nullptr;
+}
+
+/**
+ * Закрывает каналы стадии при её завершении (в том числе по исключению):
+ * следующая стадия получает конец данных, предыдущая перестаёт блокироваться.
+ */
+struct StageEnds {
+    StreamChannel *in = nullptr;
+    StreamChannel *out = nullptr;
+
+    ~StageEnds() {
+        if (out) {
+            out->close_write();
+        }
+        if (in) {
+            in->close_read();
+        }
+    }
+};
+
+}  // namespace
+
 void PipeExecutor::execute(
     const Pipe &pipe,
     std::istream &input,
     std::ostream &output,
     std::ostream &error,
     ExecutionContext &ctx
+) {
+    execute(pipe, input, output, error, ctx, mode_from_env(ctx));
+}
+
+void PipeExecutor::execute(
+    const Pipe &pipe,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    PipeMode mode
 ) {
     if (pipe.empty()) {
         return;
     }
+    TraceScope trace("pipeline", "pipeline", pipe.front().name);
+
+    if (pipe.front().id == CommandID::TIME || trace_enabled(ctx)) {
+        execute_measured(pipe, input, output, error, ctx, mode);
+        return;
+    }
 
     if (pipe.size() == 1) {
         CommandExecutor::execute(pipe[0], input, output, error, ctx);
         return;
     }
 
-    std::istringstream current_input;
-    std::ostringstream current_output;
+    if (std::ranges::all_of(pipe, [](const ParsedCommand &cmd) {
+            return cmd.id == CommandID::EXTERNAL;
+        })) {
+        ctx.set_last_status(
+            ExternalRunner::run_chain(pipe, input, output, error, ctx)
+        );
+        return;
+    }
+
+    if (mode == PipeMode::STREAMING && !mutates_context(pipe)) {
+        execute_streaming(pipe, input, output, error, ctx);
+    } else {
+        execute_sequential(pipe, input, output, error, ctx);
+    }
+}
+
+void PipeExecutor::execute_measured(
+    const Pipe &pipe,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    PipeMode mode
+) {
+    const bool timed = pipe.front().id == CommandID::TIME;
+    Pipe measured = pipe;
+    if (timed) {
+        if (pipe.front().args.empty()) {
+            measured.erase(measured.begin());
+        } else {
+            measured.front() = CommandExecutor::strip_time(pipe.front());
+        }
+    }
+
+    std::vector<StageStats> stats;
+    const auto start = std::chrono::steady_clock::now();
+    if (!measured.empty()) {
+        stats.resize(split_stages(measured).size());
+        if (mode == PipeMode::STREAMING && stats.size() > 1 &&
+            !mutates_context(measured)) {
+            execute_streaming(measured, input, output, error, ctx, &stats);
+        } else {
+            execute_sequential(measured, input, output, error, ctx, &stats);
+        }
+    }
+    const double wall = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start
+    )
+                            .count();
+
+    if (timed) {
+        print_time_report(stats, wall, error);
+    }
+    write_trace(stats, ctx, error);
+}
+
+void PipeExecutor::execute_sequential(
+    const Pipe &pipe,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    std::vector<StageStats> *stats
+) {
+    const std::vector<Stage> stages = split_stages(pipe);
+    // Стадия i пишет в buffers[i % 2] и читает записанное предыдущей.
+    const std::size_t limit = buffer_limit(ctx);
+    const std::string dir = SpillBuffer::temp_dir(ctx);
+    SpillBuffer first(limit, dir);
+    SpillBuffer second(limit, dir);
+    SpillBuffer *buffers[] = {&first, &second};
+    std::istream current_input(nullptr);
+    std::ostream current_output(nullptr);
 
-    for (std::size_t i = 0; i < pipe.size(); ++i) {
+    for (std::size_t i = 0; i < stages.size(); ++i) {
         if (ctx.is_exit()) {
             break;
         }
 
-        const ParsedCommand &cmd = pipe[i];
+        SpillBuffer &stage_buffer = *buffers[i % 2];
+        if (i < stages.size() - 1) {
+            stage_buffer.reset();
+            current_output.rdbuf(&stage_buffer);
+        }
+        const Stage stage = stages[i];
         auto &in = i == 0 ? input : current_input;
-        auto &out = i == pipe.size() - 1 ? output : current_output;
-        CommandExecutor::execute(cmd, in, out, error, ctx);
+        auto &out = i == stages.size() - 1 ? output : current_output;
+        StageStats *stage_stat = stage_stats(stats, i);
+        if (stage.size() == 1) {
+            CommandExecutor::execute(stage[0], in, out, error, ctx, stage_stat);
+        } else {
+            ctx.set_last_status(
+                run_stage(stage, in, out, error, ctx, stage_stat)
+            );
+        }
+
+        if (i < stages.size() - 1) {
+            current_output.flush();
+            if (stage_buffer.failed()) {
+                error << "fluffy-tribble: cannot write pipeline buffer to "
+                      << dir << '\n';
+            }
+            stage_buffer.rewind();
+            current_input.rdbuf(&stage_buffer);
+        }
+    }
+}
+
+void PipeExecutor::execute_streaming(
+    const Pipe &pipe,
+    std::istream &input,
+    std::ostream &output,
+    std::ostream &error,
+    ExecutionContext &ctx,
+    std::vector<StageStats> *stats
+) {
+    const std::vector<Stage> stages = split_stages(pipe);
+    const std::size_t n = stages.size();
+    std::vector<std::unique_ptr<StreamChannel>> channels;
+    channels.reserve(n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        channels.push_back(std::make_unique<StreamChannel>());
+    }
+
+    std::vector<int> statuses(n, 0);
+    std::vector<std::exception_ptr> failures(n);
+    std::mutex error_mutex;
 
-        if (i < pipe.size() - 1) {
-            current_input = std::istringstream(current_output.str());
+    auto run_worker = [&](std::size_t i) {
+        StageEnds ends{
+            .in = i > 0 ? channels[i - 1].get() : nullptr,
+            .out = i + 1 < n ? channels[i].get() : nullptr
+        };
+        try {
+            std::optional<ChannelReadBuf> in_buf;
+            std::optional<ChannelWriteBuf> out_buf;
+            SharedWriteBuf err_buf(error, error_mutex);
+            std::istream channel_in(nullptr);
+            std::ostream channel_out(nullptr);
+            std::ostream shared_err(&err_buf);
+            if (ends.in) {
+                channel_in.rdbuf(&in_buf.emplace(*ends.in));
+            }
+            if (ends.out) {
+                channel_out.rdbuf(&out_buf.emplace(*ends.out));
+            }
+
+            std::istream &in = ends.in ? channel_in : input;
+            std::ostream &out = ends.out ? channel_out : output;
+            std::ostream &err = &error == &std::cerr ? error : shared_err;
+            statuses[i] = run_stage(
+                stages[i], in, out, err, ctx, stage_stats(stats, i)
+            );
+            out.flush();
+            err.flush();
+        } catch (...) {
+            failures[i] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        workers.emplace_back(run_worker, i);
+    }
+    run_worker(n - 1);
+    for (std::thread &t : workers) {
+        t.join();
+    }
 
-            current_output.str("");
-            current_output.clear();
+    for (const std::exception_ptr &failure : failures) {
+        if (failure) {
+            std::rethrow_exception(failure);
         }
     }
+    ctx.set_last_status(statuses.back());
 }
 
 }  // namespace fluffy_tribble
@@ -0,0 +1,117 @@
+#include "plugin_loader.hpp"
+#include <dlfcn.h>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+/** Состояние, передаваемое функциям fluffy_tribble_io. */
+struct IoState {
+    std::istream &input;
+    std::ostream &output;
+    std::ostream &error;
+    const ExecutionContext &ctx;
+};
+
+ptrdiff_t io_read(void *state, char *buf, size_t size) {
+    std::streambuf *in = static_cast<IoState *>(state)->input.rdbuf();
+    if (!in || size == 0 || in->sgetc() == std::char_traits<char>::eof()) {
+        return 0;
+    }
+    // Доступное без ожидания, но не меньше одного байта (он уже есть).
+    const auto limit = static_cast<std::streamsize>(size);
+    const std::streamsize n =
+        std::min(std::max<std::streamsize>(in->in_avail(), 1), limit);
+    return static_cast<ptrdiff_t>(in->sgetn(buf, n));
+}
+
+ptrdiff_t io_write(void *state, int stream, const char *buf, size_t size) {
+    auto *io = static_cast<IoState *>(state);
+    std::ostream *out = nullptr;
+    if (stream == 1) {
+        out = &io->output;
+    } else if (stream == 2) {
+        out = &io->error;
+    }
+    if (!out || !out->write(buf, static_cast<std::streamsize>(size))) {
+        return -1;
+    }
+    return static_cast<ptrdiff_t>(size);
+}
+
+const char *io_getenv(void *state, const char *name) {
+    const auto &env = static_cast<IoState *>(state)->ctx.env();
+    auto it = env.find(name);
+    return it != env.end() ? it->second.c_str() : nullptr;
+}
+
+}  // namespace
+
+bool PluginLoader::load(
+    const std::string &path,
+    const std::vector<std::string> &names,
+    std::ostream &err
+) {
+    void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        err << "enable: cannot open shared object " << path << ": "
+            << dlerror() << '\n';
+        return false;
+    }
+    bool ok = true;
+    for (const std::string &name : names) {
+        const std::string symbol = FLUFFY_TRIBBLE_BUILTIN_PREFIX + name;
+        void *entry = dlsym(handle, symbol.c_str());
+        if (!entry) {
+            err << "enable: " << name << ": " << symbol << " not found in "
+                << path << '\n';
+            ok = false;
+            continue;
+        }
+        CommandManager::register_builtin(
+            name, wrap(name, reinterpret_cast<fluffy_tribble_builtin_fn>(entry))
+        );
+    }
+    return ok;
+}
+
+CommandManager::BuiltinFn PluginLoader::wrap(
+    const std::string &name,
+    fluffy_tribble_builtin_fn fn
+) {
+    return [name, fn](
+               const std::vector<std::string> &args,
+               std::istream &input,
+               std::ostream &output,
+               std::ostream &error,
+               ExecutionContext &ctx
+           ) {
+        std::vector<std::string> argv_strings;
+        argv_strings.reserve(args.size() + 1);
+        argv_strings.push_back(name);
+        argv_strings.insert(argv_strings.end(), args.begin(), args.end());
+        std::vector<char *> argv;
+        argv.reserve(argv_strings.size() + 1);
+        for (std::string &arg : argv_strings) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        IoState state{
+            .input = input, .output = output, .error = error, .ctx = ctx
+        };
+        const fluffy_tribble_io io{
+            .state = &state,
+            .read = &io_read,
+            .write = &io_write,
+            .getenv = &io_getenv,
+        };
+        return fn(static_cast<int>(argv_strings.size()), argv.data(), &io);
+    };
+}
+
+}  // namespace fluffy_tribble
@@ -0,0 +1,52 @@
+#include "redirect.hpp"
+#include <fcntl.h>
+
+namespace fluffy_tribble {
+
+RedirectKind redirect_kind(std::string_view op) {
+    if (op == "<") {
+        return RedirectKind::INPUT;
+    }
+    if (op == ">>") {
+        return RedirectKind::APPEND;
+    }
+    if (op == "2>") {
+        return RedirectKind::ERROR_OUTPUT;
+    }
+    if (op == "2>>") {
+        return RedirectKind::ERROR_APPEND;
+    }
+    return RedirectKind::OUTPUT;
+}
+
+int redirect_target(RedirectKind kind) {
+    switch (kind) {
+        case RedirectKind::INPUT:
+            return 0;
+        case RedirectKind::OUTPUT:
+        case RedirectKind::APPEND:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+int open_redirect(const Redirect &redirect) {
+    int flags = O_CLOEXEC;
+    switch (redirect.kind) {
+        case RedirectKind::INPUT:
+            flags |= O_RDONLY;
+            break;
+        case RedirectKind::OUTPUT:
+        case RedirectKind::ERROR_OUTPUT:
+            flags |= O_WRONLY | O_CREAT | O_TRUNC;
+            break;
+        case RedirectKind::APPEND:
+        case RedirectKind::ERROR_APPEND:
+            flags |= O_WRONLY | O_CREAT | O_APPEND;
+            break;
+    }
+    return open(redirect.path.c_str(), flags, 0666);
+}
+
+}  // namespace fluffy_tribble
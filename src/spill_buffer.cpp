@@ -0,0 +1,223 @@
+#include "spill_buffer.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+/** Начальный размер памяти буфера; дальше он удваивается до предела. */
+constexpr std::size_t kInitialMemory = 4096;
+
+}  // namespace
+
+std::string SpillBuffer::temp_dir(const ExecutionContext &ctx) {
+    auto it = ctx.env().find("TMPDIR");
+    if (it != ctx.env().end() && !it->second.empty()) {
+        return it->second;
+    }
+    return "/tmp";
+}
+
+SpillBuffer::SpillBuffer(std::size_t memory_limit, std::string temp_dir)
+    : memory_limit_(memory_limit), temp_dir_(std::move(temp_dir)) {}
+
+SpillBuffer::~SpillBuffer() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+void SpillBuffer::rewind() {
+    if (reading_) {
+        return;
+    }
+    commit_put();
+    setp(nullptr, nullptr);
+    reading_ = true;
+    file_read_ = 0;
+    setg(memory_.data(), memory_.data(), memory_.data() + memory_used_);
+}
+
+void SpillBuffer::reset() {
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+    reading_ = false;
+    failed_ = false;
+    memory_used_ = 0;
+    file_size_ = 0;
+    file_read_ = 0;
+    setg(nullptr, nullptr, nullptr);
+    setp(memory_.data(), memory_.data() + memory_.size());
+}
+
+std::uint64_t SpillBuffer::size() const {
+    std::uint64_t pending = reading_ ? 0 : pptr() - pbase();
+    return memory_used_ + file_size_ + pending;
+}
+
+bool SpillBuffer::spilled() const {
+    return fd_ != -1;
+}
+
+bool SpillBuffer::failed() const {
+    return failed_;
+}
+
+SpillBuffer::int_type SpillBuffer::overflow(int_type ch) {
+    if (reading_ || failed_ || !commit_put()) {
+        return traits_type::eof();
+    }
+    if (fd_ == -1 && memory_used_ < memory_limit_) {
+        if (memory_used_ == memory_.size()) {
+            const std::size_t grown =
+                std::max(kInitialMemory, 2 * memory_.size());
+            memory_.resize(std::min(grown, memory_limit_));
+        }
+        setp(memory_.data() + memory_used_, memory_.data() + memory_.size());
+    } else {
+        if (fd_ == -1 && !open_file()) {
+            failed_ = true;
+            return traits_type::eof();
+        }
+        block_.resize(kFileBlock);
+        setp(block_.data(), block_.data() + block_.size());
+    }
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+    return ch;
+}
+
+std::streamsize SpillBuffer::xsputn(const char *s, std::streamsize n) {
+    std::streamsize written = 0;
+    while (written < n) {
+        const auto left = static_cast<std::size_t>(n - written);
+        // Крупный блок после переполнения памяти пишется в файл напрямую.
+        if (fd_ != -1 && pptr() == pbase() && left >= kFileBlock) {
+            if (!write_file(s + written, left)) {
+                break;
+            }
+            written = n;
+            break;
+        }
+        if (pptr() == epptr()) {
+            if (traits_type::eq_int_type(
+                    overflow(traits_type::eof()), traits_type::eof()
+                )) {
+                break;
+            }
+            continue;
+        }
+        const std::size_t chunk = std::min<std::size_t>(
+            {left, static_cast<std::size_t>(epptr() - pptr()), INT_MAX}
+        );
+        std::memcpy(pptr(), s + written, chunk);
+        pbump(static_cast<int>(chunk));
+        written += static_cast<std::streamsize>(chunk);
+    }
+    return written;
+}
+
+int SpillBuffer::sync() {
+    if (reading_) {
+        return 0;
+    }
+    return commit_put() ? 0 : -1;
+}
+
+SpillBuffer::int_type SpillBuffer::underflow() {
+    if (!reading_) {
+        return traits_type::eof();
+    }
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (fd_ == -1 || file_read_ >= file_size_) {
+        return traits_type::eof();
+    }
+    block_.resize(kFileBlock);
+    const auto want = static_cast<std::size_t>(
+        std::min<std::uint64_t>(block_.size(), file_size_ - file_read_)
+    );
+    ssize_t n;
+    do {
+        n = pread(fd_, block_.data(), want, static_cast<off_t>(file_read_));
+    } while (n == -1 && errno == EINTR);
+    if (n <= 0) {
+        failed_ = true;
+        return traits_type::eof();
+    }
+    file_read_ += static_cast<std::uint64_t>(n);
+    setg(block_.data(), block_.data(), block_.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize SpillBuffer::showmanyc() {
+    if (!reading_ || file_read_ >= file_size_) {
+        return -1;
+    }
+    return static_cast<std::streamsize>(std::min<std::uint64_t>(
+        file_size_ - file_read_,
+        std::numeric_limits<std::streamsize>::max()
+    ));
+}
+
+bool SpillBuffer::commit_put() {
+    const auto pending = static_cast<std::size_t>(pptr() - pbase());
+    if (fd_ == -1) {
+        // До переполнения область записи — свободный хвост памяти.
+        memory_used_ += pending;
+        setp(pptr(), epptr());
+        return true;
+    }
+    setp(block_.data(), block_.data() + block_.size());
+    return pending == 0 || write_file(block_.data(), pending);
+}
+
+bool SpillBuffer::open_file() {
+    const std::string dir = temp_dir_.empty() ? "/tmp" : temp_dir_;
+#ifdef O_TMPFILE
+    fd_ = open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+    if (fd_ == -1) {
+        std::string pattern = dir + "/fluffy-tribble-XXXXXX";
+        fd_ = mkstemp(pattern.data());
+        if (fd_ == -1) {
+            return false;
+        }
+        unlink(pattern.c_str());
+        fcntl(fd_, F_SETFD, FD_CLOEXEC);
+    }
+    return true;
+}
+
+bool SpillBuffer::write_file(const char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd_, data, size);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed_ = true;
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        file_size_ += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+}  // namespace fluffy_tribble
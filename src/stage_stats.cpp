@@ -0,0 +1,286 @@
+#include "stage_stats.hpp"
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <fstream>
+#include <iomanip>
+#include "chrome_trace.hpp"
+#include "fd_stream.hpp"
+
+namespace fluffy_tribble {
+
+namespace {
+
+double to_seconds(const timeval &tv) {
+    return static_cast<double>(tv.tv_sec) +
+           static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+/** Процессорное время текущего потока. */
+ChildUsage thread_usage() {
+#ifdef RUSAGE_THREAD
+    rusage usage{};
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        return ChildUsage{
+            .user_seconds = to_seconds(usage.ru_utime),
+            .sys_seconds = to_seconds(usage.ru_stime),
+        };
+    }
+#endif
+    // Без RUSAGE_THREAD (macOS) доступно только суммарное время потока.
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ChildUsage{
+        .user_seconds = static_cast<double>(ts.tv_sec) +
+                        static_cast<double>(ts.tv_nsec) / 1e9,
+    };
+}
+
+/**
+ * Сколько байтов записано в файл за дескриптором: размер файла при O_APPEND,
+ * иначе текущее смещение. Пусто, если за дескриптором не обычный файл.
+ */
+std::optional<std::uint64_t> file_position(int fd) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::nullopt;
+    }
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags != -1 && (flags & O_APPEND)) {
+        return static_cast<std::uint64_t>(st.st_size);
+    }
+    const off_t pos = lseek(fd, 0, SEEK_CUR);
+    if (pos == -1) {
+        return std::nullopt;
+    }
+    return static_cast<std::uint64_t>(pos);
+}
+
+/** Пишет число байтов или заменитель unknown, если оно неизвестно. */
+struct Bytes {
+    const std::optional<std::uint64_t> &value;
+    const char *unknown;
+};
+
+std::ostream &operator<<(std::ostream &out, const Bytes &bytes) {
+    if (bytes.value) {
+        return out << *bytes.value;
+    }
+    return out << bytes.unknown;
+}
+
+void write_record(std::ostream &out, const StageStats &s, std::size_t index) {
+    out << "{\"stage\":" << index << ",\"command\":\""
+        << json_escape(s.command) << "\",\"status\":" << s.status
+        << std::fixed << std::setprecision(6)
+        << ",\"wall_s\":" << s.wall_seconds << ",\"user_s\":" << s.user_seconds
+        << ",\"sys_s\":" << s.sys_seconds
+        << ",\"bytes_in\":" << Bytes{s.bytes_in, "null"}
+        << ",\"bytes_out\":" << Bytes{s.bytes_out, "null"} << "}\n";
+}
+
+}  // namespace
+
+CountingStreamBuf::CountingStreamBuf(std::streambuf *target)
+    : target_(target) {}
+
+std::uint64_t CountingStreamBuf::count() const {
+    return count_;
+}
+
+CountingStreamBuf::int_type CountingStreamBuf::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    if (!target_) {
+        return traits_type::eof();
+    }
+    int_type r = target_->sputc(traits_type::to_char_type(ch));
+    if (!traits_type::eq_int_type(r, traits_type::eof())) {
+        ++count_;
+    }
+    return r;
+}
+
+std::streamsize CountingStreamBuf::xsputn(const char *s, std::streamsize n) {
+    if (!target_) {
+        return 0;
+    }
+    std::streamsize written = target_->sputn(s, n);
+    count_ += static_cast<std::uint64_t>(written);
+    return written;
+}
+
+int CountingStreamBuf::sync() {
+    return target_ ? target_->pubsync() : 0;
+}
+
+CountingStreamBuf::int_type CountingStreamBuf::underflow() {
+    return target_ ? target_->sgetc() : traits_type::eof();
+}
+
+CountingStreamBuf::int_type CountingStreamBuf::uflow() {
+    if (!target_) {
+        return traits_type::eof();
+    }
+    int_type ch = target_->sbumpc();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        ++count_;
+    }
+    return ch;
+}
+
+std::streamsize CountingStreamBuf::xsgetn(char *s, std::streamsize n) {
+    if (!target_) {
+        return 0;
+    }
+    std::streamsize read = target_->sgetn(s, n);
+    count_ += static_cast<std::uint64_t>(read);
+    return read;
+}
+
+std::streamsize CountingStreamBuf::showmanyc() {
+    return target_ ? target_->in_avail() : -1;
+}
+
+StageMeter::StageMeter(
+    StageStats &stats,
+    std::istream &input,
+    std::ostream &output
+)
+    : stats_(stats),
+      source_input_(input),
+      source_output_(output),
+      count_input_(stream_fd(input) < 0),
+      count_output_(stream_fd(output) < 0),
+      in_buf_(input.rdbuf()),
+      out_buf_(output.rdbuf()),
+      input_(&in_buf_),
+      output_(&out_buf_),
+      thread_start_(thread_usage()),
+      wall_start_(std::chrono::steady_clock::now()) {
+    if (!count_output_) {
+        output.flush();
+        out_start_ = file_position(stream_fd(output));
+    }
+}
+
+std::istream &StageMeter::input() {
+    return count_input_ ? input_ : source_input_;
+}
+
+std::ostream &StageMeter::output() {
+    return count_output_ ? output_ : source_output_;
+}
+
+ChildUsage &StageMeter::children() {
+    return children_;
+}
+
+void StageMeter::finish(int status) {
+    output().flush();
+    const ChildUsage thread_end = thread_usage();
+    stats_.status = status;
+    stats_.wall_seconds = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - wall_start_
+    )
+                              .count();
+    stats_.user_seconds = thread_end.user_seconds -
+                          thread_start_.user_seconds + children_.user_seconds;
+    stats_.sys_seconds = thread_end.sys_seconds - thread_start_.sys_seconds +
+                         children_.sys_seconds;
+    stats_.bytes_in = std::nullopt;
+    if (count_input_) {
+        stats_.bytes_in = in_buf_.count();
+    }
+    stats_.bytes_out = std::nullopt;
+    if (count_output_) {
+        stats_.bytes_out = out_buf_.count();
+    } else if (out_start_) {
+        const auto end = file_position(stream_fd(source_output_));
+        if (end && *end >= *out_start_) {
+            stats_.bytes_out = *end - *out_start_;
+        }
+    }
+}
+
+std::string describe_commands(std::span<const ParsedCommand> cmds) {
+    std::string text;
+    for (const ParsedCommand &cmd : cmds) {
+        if (!text.empty()) {
+            text += " | ";
+        }
+        if (cmd.id == CommandID::ASSIGN) {
+            text += '$' + cmd.name + '=' +
+                    (cmd.args.empty() ? std::string() : cmd.args[0]);
+            continue;
+        }
+        text += cmd.name;
+        // У внешних команд args[0] — само имя.
+        const std::size_t first = cmd.id == CommandID::EXTERNAL ? 1 : 0;
+        for (std::size_t i = first; i < cmd.args.size(); ++i) {
+            text += ' ';
+            text += cmd.args[i];
+        }
+    }
+    return text;
+}
+
+void print_time_report(
+    const std::vector<StageStats> &stats,
+    double wall_seconds,
+    std::ostream &out
+) {
+    double user = 0;
+    double sys = 0;
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    for (const StageStats &s : stats) {
+        out << s.wall_seconds << "s real  " << s.user_seconds << "s user  "
+            << s.sys_seconds << "s sys  " << Bytes{s.bytes_in, "?"} << " in  "
+            << Bytes{s.bytes_out, "?"} << " out  " << s.command << '\n';
+        user += s.user_seconds;
+        sys += s.sys_seconds;
+    }
+    out << "\nreal\t" << wall_seconds << "s\nuser\t" << user << "s\nsys\t"
+        << sys << "s\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool trace_enabled(const ExecutionContext &ctx) {
+    auto it = ctx.env().find(kTraceEnv);
+    return it != ctx.env().end() && !it->second.empty();
+}
+
+void write_trace(
+    const std::vector<StageStats> &stats,
+    const ExecutionContext &ctx,
+    std::ostream &error
+) {
+    auto it = ctx.env().find(kTraceEnv);
+    if (it == ctx.env().end() || it->second.empty()) {
+        return;
+    }
+    const std::string &target = it->second;
+    if (target == "1" || target == "stderr") {
+        for (std::size_t i = 0; i < stats.size(); ++i) {
+            write_record(error, stats[i], i);
+        }
+        return;
+    }
+    std::ofstream file(target, std::ios::app);
+    if (!file) {
+        error << "fluffy-tribble: " << kTraceEnv << ": cannot open '"
+              << target << "'\n";
+        return;
+    }
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        write_record(file, stats[i], i);
+    }
+}
+
+}  // namespace fluffy_tribble
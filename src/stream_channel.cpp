@@ -0,0 +1,154 @@
+#include "stream_channel.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace fluffy_tribble {
+
+namespace {
+
+constexpr std::size_t kLocalBufferSize = 8 * 1024;
+
+}  // namespace
+
+StreamChannel::StreamChannel(std::size_t capacity)
+    : ring_(std::max<std::size_t>(capacity, 1)) {}
+
+bool StreamChannel::write(const char *data, std::size_t size) {
+    std::unique_lock lock(mutex_);
+    while (size > 0) {
+        not_full_.wait(lock, [this] {
+            return read_closed_ || size_ < ring_.size();
+        });
+        if (read_closed_) {
+            return false;
+        }
+        const std::size_t tail = (head_ + size_) % ring_.size();
+        const std::size_t contiguous =
+            tail >= head_ ? ring_.size() - tail : head_ - tail;
+        const std::size_t n =
+            std::min({size, ring_.size() - size_, contiguous});
+        std::memcpy(ring_.data() + tail, data, n);
+        size_ += n;
+        data += n;
+        size -= n;
+        not_empty_.notify_one();
+    }
+    return true;
+}
+
+std::size_t StreamChannel::read(char *data, std::size_t size) {
+    std::unique_lock lock(mutex_);
+    not_empty_.wait(lock, [this] { return write_closed_ || size_ > 0; });
+    std::size_t total = 0;
+    while (total < size && size_ > 0) {
+        const std::size_t contiguous = std::min(size_, ring_.size() - head_);
+        const std::size_t n = std::min(size - total, contiguous);
+        std::memcpy(data + total, ring_.data() + head_, n);
+        head_ = (head_ + n) % ring_.size();
+        size_ -= n;
+        total += n;
+    }
+    if (total > 0) {
+        not_full_.notify_one();
+    }
+    return total;
+}
+
+std::size_t StreamChannel::available() {
+    std::lock_guard lock(mutex_);
+    return size_;
+}
+
+void StreamChannel::close_write() {
+    std::lock_guard lock(mutex_);
+    write_closed_ = true;
+    not_empty_.notify_all();
+}
+
+void StreamChannel::close_read() {
+    std::lock_guard lock(mutex_);
+    read_closed_ = true;
+    size_ = 0;
+    not_full_.notify_all();
+}
+
+ChannelWriteBuf::ChannelWriteBuf(StreamChannel &channel)
+    : channel_(channel), buffer_(kLocalBufferSize) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+ChannelWriteBuf::int_type ChannelWriteBuf::overflow(int_type ch) {
+    if (!flush_buffer()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int ChannelWriteBuf::sync() {
+    return flush_buffer() ? 0 : -1;
+}
+
+bool ChannelWriteBuf::flush_buffer() {
+    const std::size_t n = pptr() - pbase();
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return n == 0 || channel_.write(buffer_.data(), n);
+}
+
+ChannelReadBuf::ChannelReadBuf(StreamChannel &channel)
+    : channel_(channel), buffer_(kLocalBufferSize) {
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+ChannelReadBuf::int_type ChannelReadBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    const std::size_t n = channel_.read(buffer_.data(), buffer_.size());
+    if (n == 0) {
+        return traits_type::eof();
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize ChannelReadBuf::showmanyc() {
+    return static_cast<std::streamsize>(channel_.available());
+}
+
+SharedWriteBuf::SharedWriteBuf(std::ostream &target, std::mutex &mutex)
+    : target_(target), mutex_(mutex), buffer_(kLocalBufferSize) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+SharedWriteBuf::int_type SharedWriteBuf::overflow(int_type ch) {
+    flush_buffer();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+int SharedWriteBuf::sync() {
+    flush_buffer();
+    return 0;
+}
+
+void SharedWriteBuf::flush_buffer() {
+    const std::size_t n = pptr() - pbase();
+    if (n == 0) {
+        return;
+    }
+    {
+        std::lock_guard lock(mutex_);
+        target_.write(pbase(), static_cast<std::streamsize>(n));
+        target_.flush();
+    }
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+}  // namespace fluffy_tribble
@@ -0,0 +1,280 @@
+#include "wc_counter.hpp"
+#include <algorithm>
+#include <bit>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FLUFFY_TRIBBLE_WC_X86 1
+#include <immintrin.h>
+#endif
+
+namespace fluffy_tribble {
+
+namespace {
+
+/** Маски 64-байтового блока: пробельные байты и переводы строки. */
+struct BlockMasks {
+    std::uint64_t space = 0;
+    std::uint64_t newline = 0;
+};
+
+bool is_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+BlockMasks scalar_masks(const unsigned char *data) {
+    BlockMasks masks;
+    for (unsigned i = 0; i < 64; ++i) {
+        masks.space |= static_cast<std::uint64_t>(is_space(data[i])) << i;
+        masks.newline |= static_cast<std::uint64_t>(data[i] == '\n') << i;
+    }
+    return masks;
+}
+
+#ifdef FLUFFY_TRIBBLE_WC_X86
+BlockMasks sse2_masks(const unsigned char *data) {
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    const __m128i blank = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    BlockMasks masks;
+    for (unsigned i = 0; i < 4; ++i) {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(data + i * 16)
+        );
+        // Байты 9..13: (v - 9) как беззнаковое не больше 4.
+        const __m128i shifted = _mm_sub_epi8(v, tab);
+        const __m128i in_range =
+            _mm_cmpeq_epi8(_mm_min_epu8(shifted, range), shifted);
+        const __m128i space = _mm_or_si128(in_range, _mm_cmpeq_epi8(v, blank));
+        const auto space_bits =
+            static_cast<std::uint16_t>(_mm_movemask_epi8(space));
+        const auto newline_bits = static_cast<std::uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline))
+        );
+        masks.space |= static_cast<std::uint64_t>(space_bits) << (i * 16);
+        masks.newline |= static_cast<std::uint64_t>(newline_bits) << (i * 16);
+    }
+    return masks;
+}
+
+__attribute__((target("avx2"))) BlockMasks avx2_masks(
+    const unsigned char *data
+) {
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i range = _mm256_set1_epi8('\r' - '\t');
+    const __m256i blank = _mm256_set1_epi8(' ');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    BlockMasks masks;
+    for (unsigned i = 0; i < 2; ++i) {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(data + i * 32)
+        );
+        const __m256i shifted = _mm256_sub_epi8(v, tab);
+        const __m256i in_range =
+            _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, range), shifted);
+        const __m256i space =
+            _mm256_or_si256(in_range, _mm256_cmpeq_epi8(v, blank));
+        const auto space_bits =
+            static_cast<std::uint32_t>(_mm256_movemask_epi8(space));
+        const auto newline_bits = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline))
+        );
+        masks.space |= static_cast<std::uint64_t>(space_bits) << (i * 32);
+        masks.newline |= static_cast<std::uint64_t>(newline_bits) << (i * 32);
+    }
+    return masks;
+}
+#endif
+
+/** Состояние подсчёта, передаваемое между блоками. */
+struct BlockState {
+    std::size_t newlines = 0;
+    std::size_t words = 0;
+    std::uint64_t prev_space = 1;
+};
+
+/**
+ * Обрабатывает блоки функцией построения масок. Начало слова — непробельный
+ * байт, перед которым стоит пробельный (или начало данных).
+ */
+template <BlockMasks (*Masks)(const unsigned char *)>
+void count_blocks(
+    const unsigned char *data,
+    std::size_t blocks,
+    BlockState &state
+) {
+    for (std::size_t b = 0; b < blocks; ++b, data += 64) {
+        const BlockMasks m = Masks(data);
+        const std::uint64_t starts =
+            ~m.space & ((m.space << 1) | state.prev_space);
+        state.words += static_cast<std::size_t>(std::popcount(starts));
+        state.newlines += static_cast<std::size_t>(std::popcount(m.newline));
+        state.prev_space = m.space >> 63;
+    }
+}
+
+#ifdef FLUFFY_TRIBBLE_WC_X86
+// popcnt доступен на всех процессорах с AVX2.
+__attribute__((target("avx2,popcnt"))) void count_blocks_avx2(
+    const unsigned char *data,
+    std::size_t blocks,
+    BlockState &state
+) {
+    for (std::size_t b = 0; b < blocks; ++b, data += 64) {
+        const BlockMasks m = avx2_masks(data);
+        const std::uint64_t starts =
+            ~m.space & ((m.space << 1) | state.prev_space);
+        state.words += static_cast<std::size_t>(__builtin_popcountll(starts));
+        state.newlines +=
+            static_cast<std::size_t>(__builtin_popcountll(m.newline));
+        state.prev_space = m.space >> 63;
+    }
+}
+#endif
+
+}  // namespace
+
+WcCounter::WcCounter(WcKernel kernel) : kernel_(kernel) {}
+
+void WcCounter::feed(const char *data, std::size_t size) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    const std::size_t blocks = size / kBlock;
+    if (blocks > 0) {
+        feed_blocks(bytes, blocks);
+    }
+    feed_tail(bytes + blocks * kBlock, size % kBlock);
+    if (size > 0) {
+        size_ += size;
+        last_ = data[size - 1];
+    }
+}
+
+void WcCounter::feed(std::string_view data) {
+    feed(data.data(), data.size());
+}
+
+WcCounts WcCounter::counts() const {
+    // Незавершённая последняя строка считается строкой с переводом строки.
+    const std::size_t partial = last_ != '\n' ? 1 : 0;
+    return WcCounts{
+        .lines = newlines_ + partial,
+        .words = words_,
+        .bytes = size_ + partial,
+    };
+}
+
+WcCounts WcCounter::count(std::string_view data) {
+    WcCounter counter;
+    counter.feed(data);
+    return counter.counts();
+}
+
+WcCounts WcCounter::count_parallel(
+    std::string_view data,
+    std::size_t threads
+) {
+    const std::size_t parts =
+        std::clamp<std::size_t>(data.size() / kMinChunk, 1, threads);
+    if (parts == 1) {
+        return count(data);
+    }
+    // Границы частей выровнены по блоку, чтобы каждая часть шла через ядро.
+    const std::size_t chunk = (data.size() / parts + kBlock - 1) / kBlock *
+                              kBlock;
+    std::vector<WcCounter> counters(parts);
+    std::vector<std::thread> workers;
+    workers.reserve(parts - 1);
+    auto run_part = [&](std::size_t i) {
+        counters[i].feed(data.substr(i * chunk, chunk));
+    };
+    for (std::size_t i = 1; i < parts; ++i) {
+        workers.emplace_back(run_part, i);
+    }
+    run_part(0);
+    for (std::thread &t : workers) {
+        t.join();
+    }
+
+    WcCounter total;
+    for (std::size_t i = 0; i < parts; ++i) {
+        total.newlines_ += counters[i].newlines_;
+        total.words_ += counters[i].words_;
+        total.size_ += counters[i].size_;
+        // Слово на стыке частей посчитано в обеих.
+        const std::size_t edge = i * chunk;
+        if (i > 0 && !is_space(static_cast<unsigned char>(data[edge - 1])) &&
+            !is_space(static_cast<unsigned char>(data[edge]))) {
+            --total.words_;
+        }
+    }
+    total.last_ = data.back();
+    return total.counts();
+}
+
+WcKernel WcCounter::best_kernel() {
+    static const WcKernel best = [] {
+        if (kernel_supported(WcKernel::AVX2)) {
+            return WcKernel::AVX2;
+        }
+        if (kernel_supported(WcKernel::SSE2)) {
+            return WcKernel::SSE2;
+        }
+        return WcKernel::SCALAR;
+    }();
+    return best;
+}
+
+bool WcCounter::kernel_supported(WcKernel kernel) {
+    switch (kernel) {
+        case WcKernel::SCALAR:
+            return true;
+#ifdef FLUFFY_TRIBBLE_WC_X86
+        case WcKernel::SSE2:
+            return true;
+        case WcKernel::AVX2:
+            return __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("popcnt");
+#endif
+        default:
+            return false;
+    }
+}
+
+void WcCounter::feed_blocks(const unsigned char *data, std::size_t blocks) {
+    BlockState state{
+        .newlines = newlines_, .words = words_, .prev_space = prev_space_
+    };
+    switch (kernel_) {
+#ifdef FLUFFY_TRIBBLE_WC_X86
+        case WcKernel::AVX2:
+            count_blocks_avx2(data, blocks, state);
+            break;
+        case WcKernel::SSE2:
+            count_blocks<sse2_masks>(data, blocks, state);
+            break;
+#endif
+        default:
+            count_blocks<scalar_masks>(data, blocks, state);
+            break;
+    }
+    newlines_ = state.newlines;
+    words_ = state.words;
+    prev_space_ = state.prev_space;
+}
+
+void WcCounter::feed_tail(const unsigned char *data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        const bool space = is_space(data[i]);
+        if (!space && prev_space_) {
+            ++words_;
+        }
+        if (data[i] == '\n') {
+            ++newlines_;
+        }
+        prev_space_ = space ? 1 : 0;
+    }
+}
+
+}  // namespace fluffy_tribble
@@ -1,7 +1,12 @@
 #include "builtins.hpp"
+#include <fcntl.h>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 #include <sstream>
 #include "execution_context.hpp"
+#include "fd_stream.hpp"
 
 namespace fluffy_tribble {
 namespace {
@@ -52,11 +57,26 @@ TEST(BuiltinsTest, ExitWithCode) {
     ExecutionContext ctx;
     std::istringstream in;
     std::ostringstream out, err;
-    run<CommandID::EXIT>({"5"}, in, out, err, ctx);
+    EXPECT_EQ(run<CommandID::EXIT>({"5"}, in, out, err, ctx), 5);
     EXPECT_TRUE(ctx.is_exit());
     EXPECT_EQ(ctx.exit_code(), 5);
 }
 
+TEST(BuiltinsTest, ExitUsageErrors) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(run<CommandID::EXIT>({"1", "2"}, in, out, err, ctx), 1);
+    EXPECT_FALSE(ctx.is_exit());
+    EXPECT_EQ(err.str(), "exit: too many arguments\n");
+
+    err.str("");
+    EXPECT_EQ(run<CommandID::EXIT>({"abc"}, in, out, err, ctx), 2);
+    EXPECT_TRUE(ctx.is_exit());
+    EXPECT_EQ(ctx.exit_code(), 2);
+    EXPECT_EQ(err.str(), "exit: abc: numeric argument required\n");
+}
+
 TEST(BuiltinsTest, CatStdin) {
     ExecutionContext ctx;
     std::istringstream in("line1\nline2\n");
@@ -65,6 +85,64 @@ TEST(BuiltinsTest, CatStdin) {
     EXPECT_EQ(out.str(), "line1\nline2\n");
 }
 
+TEST(BuiltinsTest, CatStdinKeepsMissingNewline) {
+    ExecutionContext ctx;
+    std::istringstream in("line1\nline2");
+    std::ostringstream out, err;
+    run<CommandID::CAT>({}, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "line1\nline2");
+}
+
+TEST(BuiltinsTest, CatFileToStream) {
+    ExecutionContext ctx;
+    std::string path = testing::TempDir() + "cat_file_to_stream.txt";
+    std::string data(300000, 'x');
+    data += "\nno newline at end";
+    std::ofstream(path, std::ios::binary) << data;
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(run<CommandID::CAT>({path}, in, out, err, ctx), 0);
+    EXPECT_EQ(out.str(), data);
+    EXPECT_EQ(err.str(), "");
+    std::remove(path.c_str());
+}
+
+TEST(BuiltinsTest, CatFileToFd) {
+    ExecutionContext ctx;
+    std::string src = testing::TempDir() + "cat_file_to_fd_src.txt";
+    std::string dst = testing::TempDir() + "cat_file_to_fd_dst.txt";
+    std::string data(300000, 'y');
+    data += "\ntail";
+    std::ofstream(src, std::ios::binary) << data;
+    {
+        int fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ASSERT_NE(fd, -1);
+        FdStreamBuf buf(fd);
+        std::ostream out(&buf);
+        out << "head\n";
+        std::istringstream in;
+        std::ostringstream err;
+        run<CommandID::CAT>({src}, in, out, err, ctx);
+        EXPECT_EQ(err.str(), "");
+    }
+    std::ifstream result(dst, std::ios::binary);
+    std::string copied{
+        std::istreambuf_iterator<char>(result), std::istreambuf_iterator<char>()
+    };
+    EXPECT_EQ(copied, "head\n" + data);
+    std::remove(src.c_str());
+    std::remove(dst.c_str());
+}
+
+TEST(BuiltinsTest, CatMissingFile) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(run<CommandID::CAT>({"/nonexistent/file"}, in, out, err, ctx), 1);
+    EXPECT_EQ(out.str(), "");
+    EXPECT_EQ(err.str(), "cat: cannot open '/nonexistent/file'\n");
+}
+
 TEST(BuiltinsTest, WcStdin) {
     ExecutionContext ctx;
     std::istringstream in("one two\nthree\n");
@@ -73,6 +151,42 @@ TEST(BuiltinsTest, WcStdin) {
     EXPECT_EQ(out.str(), "2 3 14\n");
 }
 
+TEST(BuiltinsTest, WcFilesWithTotal) {
+    ExecutionContext ctx;
+    std::string a = testing::TempDir() + "wc_total_a.txt";
+    std::string b = testing::TempDir() + "wc_total_b.txt";
+    std::ofstream(a) << "one two\nthree\n";
+    std::ofstream(b) << "four";
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(
+        run<CommandID::WC>({a, "/nonexistent/file", b}, in, out, err, ctx), 1
+    );
+    EXPECT_EQ(
+        out.str(), "2 3 14 " + a + "\n1 1 5 " + b + "\n3 4 19 total\n"
+    );
+    EXPECT_EQ(err.str(), "wc: cannot open '/nonexistent/file'\n");
+    std::remove(a.c_str());
+    std::remove(b.c_str());
+}
+
+TEST(BuiltinsTest, WcLargeFileMapped) {
+    ExecutionContext ctx;
+    std::string path = testing::TempDir() + "wc_large.txt";
+    std::string line = "alpha beta gamma\n";
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (int i = 0; i < 1100000; ++i) {
+            file << line;
+        }
+    }
+    std::istringstream in;
+    std::ostringstream out, err;
+    run<CommandID::WC>({path}, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "1100000 3300000 18700000 " + path + "\n");
+    std::remove(path.c_str());
+}
+
 TEST(BuiltinsTest, EchoNoNewlineAfterEmpty) {
     ExecutionContext ctx;
     std::istringstream in;
@@ -113,5 +227,43 @@ TEST(BuiltinsTest, ExitNegativeCode) {
     EXPECT_TRUE(ctx.is_exit());
 }
 
+TEST(BuiltinsTest, HashFillListAndClear) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    run<CommandID::HASH>({"-r"}, in, out, err, ctx);
+    run<CommandID::HASH>({}, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "hash: hash table empty\n");
+
+    out.str("");
+    run<CommandID::HASH>({"sh"}, in, out, err, ctx);
+    run<CommandID::HASH>({}, in, out, err, ctx);
+    EXPECT_EQ(out.str().rfind("hits\tcommand\n", 0), 0U);
+    EXPECT_NE(out.str().find("/sh\n"), std::string::npos);
+
+    run<CommandID::HASH>({"-r"}, in, out, err, ctx);
+    EXPECT_TRUE(ctx.path_cache().entries().empty());
+}
+
+TEST(BuiltinsTest, HashUnknownProgram) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(run<CommandID::HASH>({"unknown_cmd_xyz"}, in, out, err, ctx), 1);
+    EXPECT_EQ(err.str(), "hash: unknown_cmd_xyz: not found\n");
+}
+
+TEST(BuiltinsTest, HashInvalidOption) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(run<CommandID::HASH>({"-x", "sh"}, in, out, err, ctx), 2);
+    EXPECT_EQ(
+        err.str(),
+        "hash: -x: invalid option\nhash: usage: hash [-r] [NAME...]\n"
+    );
+    EXPECT_TRUE(ctx.path_cache().entries().empty());
+}
+
 }  // namespace
 }  // namespace fluffy_tribble
@@ -0,0 +1,107 @@
+#include "chrome_trace.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "execution_context.hpp"
+#include "interpreter.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+std::string read_all(const std::string &path) {
+    std::ifstream file(path);
+    return std::string(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+    );
+}
+
+/** Значения "tid" всех событий «X». */
+std::set<std::string> complete_event_tids(const std::string &trace) {
+    std::set<std::string> tids;
+    std::istringstream lines(trace);
+    for (std::string line; std::getline(lines, line);) {
+        if (line.find("\"ph\":\"X\"") == std::string::npos) {
+            continue;
+        }
+        std::size_t pos = line.find("\"tid\":") + 6;
+        tids.insert(line.substr(pos, line.find_first_of(",}", pos) - pos));
+    }
+    return tids;
+}
+
+TEST(ChromeTraceTest, DisabledWritesNothing) {
+    ChromeTrace::stop();
+    EXPECT_FALSE(ChromeTrace::enabled());
+    TraceScope scope("test", "ignored");
+}
+
+TEST(ChromeTraceTest, WritesEventArrayWithThreadIds) {
+    const std::string path = testing::TempDir() + "chrome_trace.json";
+    ASSERT_TRUE(ChromeTrace::start(path));
+    EXPECT_TRUE(ChromeTrace::enabled());
+    {
+        TraceScope scope("test", "main_span", "say \"hi\"");
+    }
+    std::thread worker([] { TraceScope scope("test", "worker_span"); });
+    worker.join();
+    ChromeTrace::stop();
+    EXPECT_FALSE(ChromeTrace::enabled());
+    {
+        TraceScope late("test", "after_stop");
+    }
+
+    const std::string trace = read_all(path);
+    EXPECT_EQ(trace.front(), '[');
+    EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+    EXPECT_NE(trace.find("\"name\":\"process_name\""), std::string::npos);
+    EXPECT_NE(
+        trace.find("\"name\":\"main_span\",\"cat\":\"test\",\"ph\":\"X\""),
+        std::string::npos
+    );
+    EXPECT_NE(
+        trace.find("\"args\":{\"detail\":\"say \\\"hi\\\"\"}"),
+        std::string::npos
+    );
+    EXPECT_NE(trace.find("\"name\":\"worker_span\""), std::string::npos);
+    EXPECT_EQ(trace.find("after_stop"), std::string::npos);
+    EXPECT_EQ(complete_event_tids(trace).size(), 2U);
+    std::remove(path.c_str());
+}
+
+TEST(ChromeTraceTest, InterpreterStages) {
+    const std::string path = testing::TempDir() + "chrome_trace_line.json";
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+    Interpreter interpreter(ctx, in, out, err);
+    ASSERT_TRUE(ChromeTrace::start(path));
+    interpreter.execute_line("echo hello | tr a-z A-Z | wc");
+    ChromeTrace::stop();
+    EXPECT_EQ(out.str(), "1 1 6\n");
+
+    const std::string trace = read_all(path);
+    for (const char *name :
+         {"\"line\"", "\"lex\"", "\"parse\"", "\"pipeline\"", "\"execute\"",
+          "\"spawn\"", "\"relay\"", "\"wait\""}) {
+        const std::string key = std::string("\"name\":") + name;
+        EXPECT_NE(trace.find(key), std::string::npos) << name;
+    }
+    EXPECT_NE(trace.find("\"detail\":\"wc\""), std::string::npos);
+    // Стадии потокового пайплайна выполняются в своих потоках.
+    EXPECT_GE(complete_event_tids(trace).size(), 2U);
+    std::remove(path.c_str());
+}
+
+TEST(ChromeTraceTest, JsonEscape) {
+    EXPECT_EQ(json_escape("a\"b\\c"), "a\\\"b\\\\c");
+    EXPECT_EQ(json_escape(std::string("\n\x01", 2)), "\\u000a\\u0001");
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -1,5 +1,7 @@
 #include "command_manager.hpp"
 #include <gtest/gtest.h>
+#include <string>
+#include <string_view>
 #include "command_id.hpp"
 
 namespace fluffy_tribble {
@@ -16,6 +18,26 @@ TEST(CommandManagerTest, Builtins) {
     EXPECT_EQ(CommandManager::get_command_id("pwd"), CommandID::PWD);
 }
 
+TEST(CommandManagerTest, BuiltinsIgnoreCase) {
+    EXPECT_EQ(CommandManager::get_command_id("CAT"), CommandID::CAT);
+    EXPECT_EQ(CommandManager::get_command_id("Echo"), CommandID::ECHO);
+    EXPECT_EQ(CommandManager::get_command_id("TiMe"), CommandID::TIME);
+    EXPECT_EQ(CommandManager::get_command_id("hash"), CommandID::HASH);
+}
+
+TEST(CommandManagerTest, NearMissesAreExternal) {
+    // Совпадают позиция в таблице или длина, но не имя.
+    for (const char *name : {"cut", "ech", "echos", "wx", "ewit", "xc", "t"}) {
+        EXPECT_EQ(CommandManager::get_command_id(name), CommandID::EXTERNAL)
+            << name;
+    }
+    const std::string line = "catalog";
+    EXPECT_EQ(
+        CommandManager::get_command_id(std::string_view(line).substr(0, 3)),
+        CommandID::CAT
+    );
+}
+
 TEST(CommandManagerTest, External) {
     EXPECT_EQ(CommandManager::get_command_id("ls"), CommandID::EXTERNAL);
     EXPECT_EQ(
@@ -26,6 +48,9 @@ TEST(CommandManagerTest, External) {
 TEST(CommandManagerTest, RegisterCommand) {
     CommandManager::register_command("list", CommandID::CAT);
     EXPECT_EQ(CommandManager::get_command_id("list"), CommandID::CAT);
+    EXPECT_EQ(CommandManager::get_command_id("LIST"), CommandID::CAT);
+    EXPECT_EQ(CommandManager::get_command_id("lis"), CommandID::EXTERNAL);
+    EXPECT_EQ(CommandManager::get_command_id("echo"), CommandID::ECHO);
 }
 
 TEST(CommandManagerTest, ErrorUnknownCommand) {
@@ -1,6 +1,7 @@
 #include "command_parser.hpp"
 #include <gtest/gtest.h>
 #include <string>
+#include <vector>
 #include "command_id.hpp"
 #include "execution_context.hpp"
 #include "lexer.hpp"
@@ -100,6 +101,61 @@ TEST(CommandParserTest, MultiPipe) {
     EXPECT_EQ(pipe[2].name, "wc");
 }
 
+TEST(CommandParserTest, Redirections) {
+    Pipe pipe = parse_line("sort < in -r > out | wc 2>> log");
+    ASSERT_EQ(pipe.size(), 2U);
+    EXPECT_EQ(pipe[0].args, (std::vector<std::string>{"sort", "-r"}));
+    ASSERT_EQ(pipe[0].redirects.size(), 2U);
+    EXPECT_EQ(pipe[0].redirects[0].kind, RedirectKind::INPUT);
+    EXPECT_EQ(pipe[0].redirects[0].path, "in");
+    EXPECT_EQ(pipe[0].redirects[1].kind, RedirectKind::OUTPUT);
+    EXPECT_EQ(pipe[0].redirects[1].path, "out");
+    EXPECT_EQ(pipe[1].id, CommandID::WC);
+    EXPECT_TRUE(pipe[1].args.empty());
+    ASSERT_EQ(pipe[1].redirects.size(), 1U);
+    EXPECT_EQ(pipe[1].redirects[0].kind, RedirectKind::ERROR_APPEND);
+}
+
+TEST(CommandParserTest, ErrorRedirectWithoutFile) {
+    EXPECT_THROW(parse_line("echo hi >"), std::runtime_error);
+    EXPECT_THROW(parse_line("echo hi > | wc"), std::runtime_error);
+    EXPECT_THROW(parse_line("> out"), std::runtime_error);
+}
+
+Pipe parse_list_single(const std::string &line, ListOp op) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    CommandList list = parser.parse_list(lexer.tokenize(line, ctx));
+    EXPECT_EQ(list.size(), 1U);
+    EXPECT_EQ(list.front().op, op);
+    return list.front().pipe;
+}
+
+TEST(CommandParserTest, BackgroundList) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    CommandList list =
+        parser.parse_list(lexer.tokenize("sleep 1 & echo a | wc &", ctx));
+    ASSERT_EQ(list.size(), 2U);
+    EXPECT_EQ(list[0].op, ListOp::BACKGROUND);
+    EXPECT_EQ(list[0].pipe[0].name, "sleep");
+    EXPECT_EQ(list[1].op, ListOp::BACKGROUND);
+    EXPECT_EQ(list[1].pipe.size(), 2U);
+
+    EXPECT_EQ(parse_list_single("echo a", ListOp::SEQUENCE).size(), 1U);
+    EXPECT_TRUE(parser.parse_list(lexer.tokenize("", ctx)).empty());
+    EXPECT_THROW(parse_line("echo a &"), std::runtime_error);
+    EXPECT_THROW(
+        parser.parse_list(lexer.tokenize("& echo a", ctx)), std::runtime_error
+    );
+    EXPECT_THROW(
+        parser.parse_list(lexer.tokenize("echo a & &", ctx)),
+        std::runtime_error
+    );
+}
+
 TEST(CommandParserTest, ErrorUnclosedQuote) {
     EXPECT_THROW(parse_line("echo 'unclosed"), std::runtime_error);
 }
@@ -118,9 +174,34 @@ TEST(CommandParserTest, ErrorMissingCommand) {
 }
 
 TEST(CommandParserTest, ErrorConsecutivePipes) {
-    Pipe pipe = parse_line("echo test ||");
+    Pipe pipe = parse_line("echo test | |");
     EXPECT_GE(pipe.size(), 1U);
     EXPECT_EQ(pipe[0].name, "echo");
+    // Слитные || — оператор списка, а не два пайпа.
+    EXPECT_THROW(parse_line("echo test ||"), std::runtime_error);
+}
+
+TEST(CommandParserTest, SequenceAndConditionalLists) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    CommandList list = parser.parse_list(
+        lexer.tokenize("cd /tmp; test -d x && echo y || echo n | wc;", ctx)
+    );
+    ASSERT_EQ(list.size(), 4U);
+    EXPECT_EQ(list[0].op, ListOp::SEQUENCE);
+    EXPECT_EQ(list[1].op, ListOp::AND);
+    EXPECT_EQ(list[1].pipe[0].args.size(), 3U);
+    EXPECT_EQ(list[2].op, ListOp::OR);
+    EXPECT_EQ(list[3].op, ListOp::SEQUENCE);
+    EXPECT_EQ(list[3].pipe.size(), 2U);
+
+    for (const char *line : {"; echo a", "echo a && && echo b", "echo a ||",
+                             "echo a &&", "echo a ;; echo b", "&& echo a"}) {
+        EXPECT_THROW(
+            parser.parse_list(lexer.tokenize(line, ctx)), std::runtime_error
+        ) << line;
+    }
 }
 
 }  // namespace
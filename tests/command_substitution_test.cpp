@@ -0,0 +1,114 @@
+#include "command_substitution.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "execution_context.hpp"
+#include "interpreter.hpp"
+#include "lexer.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+TEST(CommandSubstitutionTest, FindEnd) {
+    const auto end = [](std::string_view text) {
+        return CommandSubstitution::find_end(text, 2);
+    };
+    EXPECT_EQ(end("$(pwd)"), 5U);
+    EXPECT_EQ(end("$(echo (a) b) c"), 12U);
+    EXPECT_EQ(end("$(echo ')' \")\" \\)) x"), 17U);
+    EXPECT_EQ(end("$(echo \"$(pwd)\")"), 15U);
+    EXPECT_EQ(end("$(echo $(pwd))"), 13U);
+    EXPECT_EQ(end("$(echo"), std::string_view::npos);
+    EXPECT_EQ(end("$(echo ')"), std::string_view::npos);
+}
+
+TEST(CommandSubstitutionTest, BuiltinsRunInProcess) {
+    ExecutionContext ctx;
+    ctx.set_env("X", "1");
+    std::ostringstream err;
+    const auto run = [&](std::string_view commands) {
+        return CommandSubstitution::run(commands, ctx, err);
+    };
+    EXPECT_EQ(run("pwd"), ctx.cwd());
+    EXPECT_EQ(run("echo a b | wc"), "1 2 4");
+    EXPECT_EQ(run("echo $X; echo"), "1");
+    // Присваивания и exit действуют только на копию контекста.
+    EXPECT_EQ(run("$X=2; exit 4; echo no"), "");
+    EXPECT_EQ(ctx.env().at("X"), "1");
+    EXPECT_FALSE(ctx.is_exit());
+    EXPECT_THROW(run("echo; ;"), std::runtime_error);
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(CommandSubstitutionTest, ExternalAndBackgroundCommands) {
+    ExecutionContext ctx;
+    std::ostringstream err;
+    EXPECT_EQ(CommandSubstitution::run("printf 'a\\n\\n\\n'", ctx, err), "a");
+    EXPECT_EQ(CommandSubstitution::run("echo bg | cat &", ctx, err), "bg");
+}
+
+TEST(CommandSubstitutionTest, ErrorsGoToGivenStream) {
+    ExecutionContext ctx;
+    std::ostringstream err;
+    EXPECT_EQ(
+        CommandSubstitution::run("sh -c 'echo oops >&2; echo out'", ctx, err),
+        "out"
+    );
+    EXPECT_EQ(err.str(), "oops\n");
+}
+
+TEST(CommandSubstitutionTest, LexerSubstitutesIntoWord) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    auto ts = lexer.tokenize(
+        "echo x$(echo a b)y \"$(echo \"$(echo in)\")\" '$(no)'", ctx
+    );
+    ASSERT_EQ(ts.size(), 5U);
+    EXPECT_EQ(ts[1].value, "xa by");
+    EXPECT_EQ(ts[2].value, "in");
+    EXPECT_EQ(ts[3].value, "$(no)");
+    EXPECT_THROW(lexer.tokenize("echo $(echo", ctx), std::runtime_error);
+}
+
+TEST(CommandSubstitutionTest, ScriptRunsSubstitutionInOrder) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    const std::string path = testing::TempDir() + "substitution.txt";
+    // Подстановка выполняется в свою очередь, а не при разборе скрипта.
+    interpreter.run_script(
+        "echo one > " + path + "\necho $(cat " + path + ")\n" +
+        "echo two > " + path + "\necho $(cat " + path + ")\n"
+    );
+    EXPECT_EQ(out.str(), "one\ntwo\n");
+    EXPECT_EQ(err.str(), "");
+    std::remove(path.c_str());
+}
+
+TEST(CommandSubstitutionTest, RunsWhenItsListElementRuns) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    const std::string skipped = testing::TempDir() + "substitution_skip.txt";
+    const std::string path = testing::TempDir() + "substitution_line.txt";
+    std::remove(skipped.c_str());
+    // Пропущенный после && элемент не выполняет свою подстановку, а
+    // следующий после ; видит результат предыдущего.
+    interpreter.run_script(
+        "false && echo $(echo SIDE > " + skipped + ")\n" +
+        "echo first > " + path + "; echo got $(cat " + path + ")\n" +
+        "echo $(sh -c 'echo oops >&2')"
+    );
+    EXPECT_EQ(out.str(), "got first\n\n");
+    EXPECT_EQ(err.str(), "oops\n");
+    EXPECT_EQ(std::fopen(skipped.c_str(), "r"), nullptr);
+    std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -1,5 +1,7 @@
 #include "execution_context.hpp"
 #include <gtest/gtest.h>
+#include <string>
+#include <utility>
 
 namespace fluffy_tribble {
 namespace {
@@ -13,6 +15,35 @@ TEST(ExecutionContextTest, Env) {
     EXPECT_EQ(it->second, "test_value");
 }
 
+TEST(ExecutionContextTest, NewEmptyVariableChangesVersion) {
+    ExecutionContext ctx;
+    ctx.unset_env("FLUFFY_TEST_EMPTY");
+    const auto version = ctx.env_version();
+    ctx.set_env("FLUFFY_TEST_EMPTY", "");
+    EXPECT_NE(ctx.env_version(), version);
+    EXPECT_EQ(ctx.env().count("FLUFFY_TEST_EMPTY"), 1U);
+}
+
+TEST(ExecutionContextTest, UnsetEnvRebuildsEnvBlock) {
+    ExecutionContext ctx;
+    ctx.set_env("FLUFFY_TEST_UNSET", "1");
+    auto before = ctx.env_block();
+    const auto version = ctx.env_version();
+    ctx.unset_env("FLUFFY_TEST_UNSET");
+    EXPECT_NE(ctx.env_version(), version);
+    EXPECT_EQ(ctx.env().count("FLUFFY_TEST_UNSET"), 0U);
+    auto after = ctx.env_block();
+    EXPECT_NE(after, before);
+    for (char *const *p = after->envp(); *p; ++p) {
+        EXPECT_NE(std::string(*p), "FLUFFY_TEST_UNSET=1");
+    }
+
+    const auto unchanged = ctx.env_version();
+    ctx.unset_env("FLUFFY_TEST_UNSET");
+    EXPECT_EQ(ctx.env_version(), unchanged);
+    EXPECT_EQ(ctx.env_block(), after);
+}
+
 TEST(ExecutionContextTest, Cwd) {
     ExecutionContext ctx;
     std::string cwd = ctx.cwd();
@@ -80,5 +111,35 @@ TEST(ExecutionContextTest, ErrorChangeExitCodeAfterSet) {
     EXPECT_EQ(ctx.exit_code(), 0);
 }
 
+TEST(ExecutionContextTest, EnvBlockCachedUntilChange) {
+    ExecutionContext ctx;
+    ctx.set_env("BLOCK_VAR", "one");
+    auto first = ctx.env_block();
+    EXPECT_EQ(ctx.env_block(), first);
+
+    ctx.set_env("BLOCK_VAR", "one");
+    EXPECT_EQ(ctx.env_block(), first);
+
+    ctx.set_env("BLOCK_VAR", "two");
+    auto second = ctx.env_block();
+    EXPECT_NE(second, first);
+
+    bool found = false;
+    for (char *const *p = second->envp(); *p; ++p) {
+        found = found || std::string(*p) == "BLOCK_VAR=two";
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(ExecutionContextTest, EnvBlockMatchesEnv) {
+    ExecutionContext ctx;
+    ctx.set_env("EMPTY", "");
+    std::size_t count = 0;
+    for (char *const *p = ctx.env_block()->envp(); *p; ++p) {
+        ++count;
+    }
+    EXPECT_EQ(count, std::as_const(ctx).env().size());
+}
+
 }  // namespace
 }  // namespace fluffy_tribble
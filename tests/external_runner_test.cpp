@@ -0,0 +1,140 @@
+#include "external_runner.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+// Input that ends only after the program has written something: the output
+// buffer opens the gate on its first write
+struct Gate {
+    std::mutex mutex;
+    std::condition_variable opened;
+    bool open = false;
+    bool timed_out = false;
+};
+
+class GatedInputBuf : public std::streambuf {
+public:
+    explicit GatedInputBuf(Gate &gate) : gate_(gate) {}
+
+protected:
+    int_type underflow() override {
+        std::unique_lock lock(gate_.mutex);
+        gate_.timed_out = !gate_.opened.wait_for(
+            lock, std::chrono::seconds(5), [this] { return gate_.open; }
+        );
+        return traits_type::eof();
+    }
+
+private:
+    Gate &gate_;
+};
+
+class GateOpeningBuf : public std::stringbuf {
+public:
+    explicit GateOpeningBuf(Gate &gate) : gate_(gate) {}
+
+protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        {
+            std::lock_guard lock(gate_.mutex);
+            gate_.open = true;
+        }
+        gate_.opened.notify_all();
+        return std::stringbuf::xsputn(s, n);
+    }
+
+private:
+    Gate &gate_;
+};
+
+TEST(ExternalRunnerTest, OutputFlowsWhileInputIsPending) {
+    // stdout must be drained while the istream is still waiting for data
+    ExecutionContext ctx;
+    Gate gate;
+    GatedInputBuf in_buf(gate);
+    GateOpeningBuf out_buf(gate);
+    std::istream in(&in_buf);
+    std::ostream out(&out_buf);
+    std::ostringstream err;
+    int status = ExternalRunner::run(
+        "sh", {"sh", "-c", "echo early; cat"}, in, out, err, ctx
+    );
+    EXPECT_EQ(status, 0);
+    EXPECT_FALSE(gate.timed_out);
+    EXPECT_EQ(out_buf.str(), "early\n");
+}
+
+TEST(ExternalRunnerTest, RelaysLargeInputAndOutput) {
+    // Both directions exceed pipe capacity: the relay must not deadlock
+    ExecutionContext ctx;
+    std::string data;
+    for (int i = 0; i < 200000; ++i) {
+        data += std::to_string(i) + '\n';
+    }
+    std::istringstream in(data);
+    std::ostringstream out, err;
+    int status = ExternalRunner::run("cat", {"cat"}, in, out, err, ctx);
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(out.str(), data);
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(ExternalRunnerTest, RelaysStderr) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    int status = ExternalRunner::run(
+        "sh", {"sh", "-c", "echo out; echo err >&2; exit 3"}, in, out, err, ctx
+    );
+    EXPECT_EQ(status, 3);
+    EXPECT_EQ(out.str(), "out\n");
+    EXPECT_EQ(err.str(), "err\n");
+}
+
+TEST(ExternalRunnerTest, ProgramIgnoringInput) {
+    ExecutionContext ctx;
+    std::istringstream in(std::string(1 << 20, 'x'));
+    std::ostringstream out, err;
+    int status = ExternalRunner::run("true", {"true"}, in, out, err, ctx);
+    EXPECT_EQ(status, 0);
+}
+
+// The program closes its pipes before exiting: the relay loop has nothing
+// left to read and must still pick up the exit status from its pidfd.
+TEST(ExternalRunnerTest, ReapsProgramAfterPipesClose) {
+    ExecutionContext ctx;
+    std::istringstream in("data\n");
+    std::ostringstream out, err;
+    int status = ExternalRunner::run(
+        "sh",
+        {"sh", "-c", "echo before; exec <&- >&- 2>&-; sleep 0.2; exit 4"},
+        in,
+        out,
+        err,
+        ctx
+    );
+    EXPECT_EQ(status, 4);
+    EXPECT_EQ(out.str(), "before\n");
+}
+
+TEST(ExternalRunnerTest, ErrorCommandNotFound) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    int status = ExternalRunner::run("unknown_cmd_xyz", {}, in, out, err, ctx);
+    EXPECT_EQ(status, 127);
+    EXPECT_EQ(
+        err.str(), "fluffy-tribble: unknown_cmd_xyz: command not found\n"
+    );
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
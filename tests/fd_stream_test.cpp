@@ -0,0 +1,129 @@
+#include "fd_stream.hpp"
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace fluffy_tribble {
+namespace {
+
+std::string read_file(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+    };
+}
+
+TEST(FdStreamTest, StreamFdOfStandardStreams) {
+    EXPECT_EQ(stream_fd(std::cin), 0);
+    EXPECT_EQ(stream_fd(std::cout), 1);
+    EXPECT_EQ(stream_fd(std::cerr), 2);
+    std::ostringstream out;
+    EXPECT_EQ(stream_fd(out), -1);
+}
+
+TEST(FdStreamTest, WriteAndReadThroughPipe) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::string data(200000, 'a');
+    data += "end";
+    std::thread writer([&] {
+        FdStreamBuf buf(fds[1]);
+        std::ostream out(&buf);
+        EXPECT_EQ(stream_fd(out), fds[1]);
+        out << "small\n";
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    });
+    FdStreamBuf buf(fds[0]);
+    std::istream in(&buf);
+    std::string received{
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()
+    };
+    writer.join();
+    EXPECT_EQ(received, "small\n" + data);
+}
+
+TEST(FdStreamTest, CopyFileToFile) {
+    std::string src = testing::TempDir() + "fd_stream_copy_src.txt";
+    std::string dst = testing::TempDir() + "fd_stream_copy_dst.txt";
+    std::string data;
+    for (int i = 0; i < 100000; ++i) {
+        data += std::to_string(i) + '\n';
+    }
+    std::ofstream(src, std::ios::binary) << data;
+    int in_fd = open(src.c_str(), O_RDONLY);
+    int out_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(in_fd, -1);
+    ASSERT_NE(out_fd, -1);
+    EXPECT_TRUE(copy_fd(in_fd, out_fd));
+    close(in_fd);
+    close(out_fd);
+    EXPECT_EQ(read_file(dst), data);
+    std::remove(src.c_str());
+    std::remove(dst.c_str());
+}
+
+TEST(FdStreamTest, CopyFileToPipe) {
+    std::string src = testing::TempDir() + "fd_stream_pipe_src.txt";
+    std::string data(500000, 'p');
+    std::ofstream(src, std::ios::binary) << data;
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::thread writer([&] {
+        int in_fd = open(src.c_str(), O_RDONLY);
+        EXPECT_TRUE(copy_fd(in_fd, fds[1]));
+        close(in_fd);
+        close(fds[1]);
+    });
+    FdStreamBuf buf(fds[0]);
+    std::istream in(&buf);
+    std::string received{
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()
+    };
+    writer.join();
+    EXPECT_EQ(received, data);
+    std::remove(src.c_str());
+}
+
+double thread_cpu_seconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + ts.tv_nsec / 1e9;
+}
+
+TEST(FdStreamTest, CopyFromNonBlockingPipeWaits) {
+    std::string dst = testing::TempDir() + "fd_stream_nonblock_dst.txt";
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    // Данные приходят с паузами: копирование должно ждать, а не крутиться.
+    std::thread writer([&] {
+        for (int i = 0; i < 3; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            ASSERT_EQ(write(fds[1], "chunk\n", 6), 6);
+        }
+        close(fds[1]);
+    });
+    int out_fd = open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(out_fd, -1);
+    const double cpu_before = thread_cpu_seconds();
+    EXPECT_TRUE(copy_fd(fds[0], out_fd));
+    const double cpu = thread_cpu_seconds() - cpu_before;
+    writer.join();
+    close(fds[0]);
+    close(out_fd);
+    EXPECT_EQ(read_file(dst), "chunk\nchunk\nchunk\n");
+    EXPECT_LT(cpu, 0.1);
+    std::remove(dst.c_str());
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,181 @@
+#include "interpreter.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+TEST(InterpreterTest, InteractivePrompt) {
+    ExecutionContext ctx;
+    std::istringstream in("echo hi\n");
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    EXPECT_EQ(interpreter.run_interactive(true), 0);
+    EXPECT_EQ(out.str(), "$ hi\n$ ");
+}
+
+TEST(InterpreterTest, InteractiveWithoutPrompt) {
+    ExecutionContext ctx;
+    std::istringstream in("echo hi\necho there\n");
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    EXPECT_EQ(interpreter.run_interactive(false), 0);
+    EXPECT_EQ(out.str(), "hi\nthere\n");
+}
+
+TEST(InterpreterTest, ScriptStopsAtExit) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    int code = interpreter.run_script("$X=1\necho $X\nexit 3\necho no");
+    EXPECT_EQ(code, 3);
+    EXPECT_EQ(out.str(), "1\n");
+}
+
+TEST(InterpreterTest, RepeatedLineSeesVariableChanges) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.run_script(
+        "$X=a\necho $X | cat\n$X=b\necho $X | cat\n$X=b\necho $X | cat"
+    );
+    EXPECT_EQ(out.str(), "a\nb\nb\n");
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(InterpreterTest, BackgroundJobRunsOnContextCopy) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.run_script(
+        "$X=a\necho $X | cat & $Y=1 &\n$X=b\nwait $!\nwait %1\n"
+        "echo $X $Y $!\njobs"
+    );
+    EXPECT_EQ(out.str(), "a\nb 2\n");
+    EXPECT_EQ(err.str(), "");
+    EXPECT_EQ(ctx.jobs().size(), 0U);
+}
+
+TEST(InterpreterTest, WaitReturnsJobStatus) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.run_script("sh -c 'exit 3' &\nwait $!");
+    EXPECT_EQ(ctx.last_status(), 3);
+    interpreter.run_script("wait 7");
+    EXPECT_EQ(ctx.last_status(), 127);
+    EXPECT_EQ(err.str(), "wait: 7: no such job\n");
+}
+
+TEST(InterpreterTest, LastJobOnSameLine) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    // $! подставляется после запуска задания, стоящего раньше в строке.
+    interpreter.run_script("sleep 0.1 & echo J $!\nsh -c 'exit 3' & wait $!");
+    EXPECT_EQ(out.str(), "J 1\n");
+    EXPECT_EQ(ctx.last_status(), 3);
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(InterpreterTest, SequenceAndConditionalLists) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.run_script(
+        "false && echo no || echo yes; true || echo no && echo yes2\n"
+        "sh -c 'exit 4' && echo no; echo after\n"
+        "false || echo bg | cat &\nwait $!"
+    );
+    EXPECT_EQ(out.str(), "yes\nyes2\nafter\nbg\n");
+    EXPECT_EQ(err.str(), "");
+    EXPECT_EQ(ctx.last_status(), 0);
+
+    interpreter.run_script("true && exit 5 || echo no\necho no");
+    EXPECT_EQ(out.str(), "yes\nyes2\nafter\nbg\n");
+    EXPECT_EQ(ctx.exit_code(), 5);
+}
+
+TEST(InterpreterTest, AssignmentVisibleLaterOnSameLine) {
+    ExecutionContext ctx;
+    std::istringstream in("$x=1; echo X $x\n$y=foo && echo $y\n");
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    // Подстановки выполняются перед запуском каждого элемента списка.
+    interpreter.run_interactive(false);
+    interpreter.run_script("$x=2; echo X $x\n$y=bar && echo $y | cat");
+    EXPECT_EQ(out.str(), "X 1\nfoo\nX 2\nbar\n");
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(InterpreterTest, ConditionalListsUseBuiltinStatus) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.run_script(
+        "cat /nonexistent/file && echo no\n"
+        "wc /nonexistent/file || echo wc failed\n"
+        "enable -f /nonexistent/lib.so x && echo no\n"
+        "echo a | cat && echo ok"
+    );
+    EXPECT_EQ(out.str(), "wc failed\na\nok\n");
+    EXPECT_EQ(ctx.last_status(), 0);
+}
+
+TEST(InterpreterTest, ScriptErrorsReportedInOrder) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out;
+    Interpreter interpreter(ctx, in, out, out);
+    // Весь скрипт разбирается до выполнения, а ошибка строки выводится,
+    // когда до неё доходит очередь.
+    interpreter.run_script("echo a\necho b ||\n$X=c\necho $X");
+    EXPECT_EQ(out.str(), "a\nError: Missing command after ||\nc\n");
+}
+
+TEST(InterpreterTest, ScriptLexerErrorContinues) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    EXPECT_EQ(interpreter.run_script("echo 'open\necho after\n"), 0);
+    EXPECT_EQ(out.str(), "after\n");
+    EXPECT_NE(err.str().find("Error: "), std::string::npos);
+}
+
+TEST(InterpreterTest, ScriptFile) {
+    ExecutionContext ctx;
+    std::string path = testing::TempDir() + "interpreter_script.ft";
+    std::ofstream(path) << "echo one\n\necho two | wc\n";
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    EXPECT_EQ(interpreter.run_file(path), 0);
+    EXPECT_EQ(out.str(), "one\n1 1 4\n");
+    std::remove(path.c_str());
+}
+
+TEST(InterpreterTest, ErrorMissingScriptFile) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    EXPECT_EQ(interpreter.run_file("/nonexistent/script.ft"), 127);
+    EXPECT_EQ(
+        err.str(), "fluffy-tribble: /nonexistent/script.ft: cannot open\n"
+    );
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
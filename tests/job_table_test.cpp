@@ -0,0 +1,91 @@
+#include "job_table.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fluffy_tribble {
+namespace {
+
+TEST(JobTableTest, WaitReturnsStatusAndRemovesJob) {
+    JobTable jobs;
+    const int first = jobs.start("true &", [] { return 0; });
+    const int second = jobs.start("false &", [] { return 3; });
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(second, 2);
+    EXPECT_EQ(jobs.wait(second), 3);
+    EXPECT_EQ(jobs.wait(second), std::nullopt);
+    EXPECT_EQ(jobs.wait(first), 0);
+    EXPECT_EQ(jobs.size(), 0U);
+    EXPECT_EQ(jobs.start("again &", [] { return 0; }), 1);
+}
+
+TEST(JobTableTest, ListReportsRunningThenFinished) {
+    JobTable jobs;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    jobs.start("sleep &", [released] {
+        released.wait();
+        return 2;
+    });
+
+    auto running = jobs.list();
+    ASSERT_EQ(running.size(), 1U);
+    EXPECT_FALSE(running[0].done);
+    EXPECT_EQ(JobTable::describe(running[0]), "[1]  Running\tsleep &");
+
+    release.set_value();
+    std::vector<JobTable::JobInfo> finished;
+    while (finished.empty()) {
+        finished = jobs.take_finished();
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(JobTable::describe(finished[0]), "[1]  Exit 2\tsleep &");
+    EXPECT_TRUE(jobs.list().empty());
+}
+
+TEST(JobTableTest, ReapRunsWhenJobIsCollected) {
+    JobTable jobs;
+    std::atomic<int> reaped{0};
+    jobs.start("a &", [] { return 0; }, [&reaped] { ++reaped; });
+    jobs.start("b &", [] { return 0; }, [&reaped] { ++reaped; });
+    EXPECT_EQ(reaped.load(), 0);
+    jobs.wait_all();
+    EXPECT_EQ(reaped.load(), 2);
+    EXPECT_EQ(jobs.size(), 0U);
+}
+
+TEST(JobTableTest, JobsRunConcurrently) {
+    JobTable jobs;
+    std::promise<void> arrived[2];
+    std::shared_future<void> seen[2] = {
+        arrived[0].get_future().share(), arrived[1].get_future().share()
+    };
+    // Каждое задание ждёт другое: по очереди они бы не завершились.
+    for (int i = 0; i < 2; ++i) {
+        jobs.start("meet &", [&arrived, other = seen[1 - i], i] {
+            arrived[i].set_value();
+            return other.wait_for(std::chrono::seconds(10)) ==
+                           std::future_status::ready
+                       ? 0
+                       : 1;
+        });
+    }
+    EXPECT_EQ(jobs.wait(1), 0);
+    EXPECT_EQ(jobs.wait(2), 0);
+}
+
+TEST(JobTableTest, ExceptionBecomesFailureStatus) {
+    JobTable jobs;
+    const int id = jobs.start("throw &", []() -> int {
+        throw std::runtime_error("boom");
+    });
+    EXPECT_EQ(jobs.wait(id), 1);
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
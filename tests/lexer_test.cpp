@@ -1,11 +1,35 @@
 #include "lexer.hpp"
 #include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "execution_context.hpp"
+#include "expander.hpp"
+#include "lexer_scan.hpp"
+#include "line_arena.hpp"
 #include "token.hpp"
 
 namespace fluffy_tribble {
 namespace {
 
+/** Значение токена-представления после подстановок. */
+std::string expanded(const TokenView &token, const ExecutionContext &ctx) {
+    std::vector<Expansion> expansions;
+    for (const ExpansionView &view : token.expansions) {
+        expansions.push_back(
+            Expansion{
+                .kind = view.kind,
+                .pos = view.pos,
+                .text = std::string(view.text),
+            }
+        );
+    }
+    std::ostringstream error;
+    return Expander::expand(token.value, expansions, ctx, error);
+}
+
 TEST(LexerTest, BasicTokenization) {
     ExecutionContext ctx;
     Lexer lexer;
@@ -111,6 +135,82 @@ TEST(LexerTest, Operators) {
     EXPECT_EQ(ts3[3].value, "value");
 }
 
+TEST(LexerTest, Redirections) {
+    ExecutionContext ctx;
+    Lexer lexer;
+
+    auto ts = lexer.tokenize("sort<in >out >>log 2>err 2>>all", ctx);
+    ASSERT_EQ(ts.size(), 12U);
+    EXPECT_EQ(ts[0].value, "sort");
+    const std::pair<const char *, const char *> expected[] = {
+        {"<", "in"}, {">", "out"}, {">>", "log"}, {"2>", "err"}, {"2>>", "all"}
+    };
+    for (std::size_t i = 0; i < std::size(expected); ++i) {
+        EXPECT_EQ(ts[1 + 2 * i].type, TokenType::OP_REDIRECT);
+        EXPECT_EQ(ts[1 + 2 * i].value, expected[i].first);
+        EXPECT_EQ(ts[2 + 2 * i].type, TokenType::WORD);
+        EXPECT_EQ(ts[2 + 2 * i].value, expected[i].second);
+    }
+
+    // 2 — номер потока, только если это отдельное слово без кавычек.
+    auto ts2 = lexer.tokenize("echo x2>f '2'>g \\>h \">\"", ctx);
+    ASSERT_EQ(ts2.size(), 10U);
+    EXPECT_EQ(ts2[1].value, "x2");
+    EXPECT_EQ(ts2[2].value, ">");
+    EXPECT_EQ(ts2[4].value, "2");
+    EXPECT_EQ(ts2[5].value, ">");
+    EXPECT_EQ(ts2[7].value, ">h");
+    EXPECT_EQ(ts2[8].type, TokenType::WORD);
+    EXPECT_EQ(ts2[8].value, ">");
+}
+
+TEST(LexerTest, BackgroundAndLastJob) {
+    ExecutionContext ctx;
+    Lexer lexer;
+
+    // Без фоновых заданий $! пуст.
+    auto ts = lexer.tokenize("sleep 1& echo '&' $!", ctx);
+    ASSERT_EQ(ts.size(), 6U);
+    EXPECT_EQ(ts[2].type, TokenType::OP_BACKGROUND);
+    EXPECT_EQ(ts[4].type, TokenType::WORD);
+    EXPECT_EQ(ts[4].value, "&");
+
+    // В представлениях $! только отмечается и подставляется при запуске.
+    ctx.set_env(std::string(ExecutionContext::kLastJobVar), "4");
+    LineArena arena;
+    auto views = lexer.tokenize_views("wait $!", arena);
+    ASSERT_EQ(views.size(), 3U);
+    EXPECT_EQ(views[1].value, "");
+    ASSERT_EQ(views[1].expansions.size(), 1U);
+    EXPECT_EQ(views[1].expansions[0].text, ExecutionContext::kLastJobVar);
+    EXPECT_EQ(expanded(views[1], ctx), "4");
+}
+
+TEST(LexerTest, ListOperators) {
+    ExecutionContext ctx;
+    Lexer lexer;
+
+    auto ts = lexer.tokenize("a;b&&c||d|e&f ';' \"&&\"", ctx);
+    std::vector<TokenType> types;
+    for (const Token &t : ts) {
+        types.push_back(t.type);
+    }
+    EXPECT_EQ(
+        types,
+        (std::vector<TokenType>{
+            TokenType::WORD, TokenType::OP_SEQUENCE, TokenType::WORD,
+            TokenType::OP_AND, TokenType::WORD, TokenType::OP_OR,
+            TokenType::WORD, TokenType::OP_PIPE, TokenType::WORD,
+            TokenType::OP_BACKGROUND, TokenType::WORD, TokenType::WORD,
+            TokenType::WORD, TokenType::EOF_
+        })
+    );
+    EXPECT_EQ(ts[3].value, "&&");
+    EXPECT_EQ(ts[5].value, "||");
+    EXPECT_EQ(ts[11].value, ";");
+    EXPECT_EQ(ts[12].value, "&&");
+}
+
 TEST(LexerTest, QuotedCharacters) {
     ExecutionContext ctx;
     Lexer lexer;
@@ -150,5 +250,89 @@ TEST(LexerTest, UnclosedQuotesMultiple) {
     );
 }
 
+TEST(LexerTest, ViewsMatchOwningTokens) {
+    ExecutionContext ctx;
+    ctx.set_env("VAR", "value");
+    // Пустое после подстановки слово отбрасывается только при запуске.
+    ctx.set_env(std::string(ExecutionContext::kLastJobVar), "1");
+    Lexer lexer;
+    LineArena arena;
+    for (const std::string line :
+         {"echo hello world", "cat file | wc", "'a b' \"c $VAR\" d\\|e",
+          "$X=1", "FOO=bar env", "a\"b\"c $VAR$VAR \"x\\ny\\q\"", "$ ''",
+          "cmd<in 2>err >>out x2>y", "a&b '&' $!"}) {
+        auto owning = lexer.tokenize(line, ctx);
+        auto views = lexer.tokenize_views(line, arena);
+        ASSERT_EQ(views.size(), owning.size()) << line;
+        for (std::size_t i = 0; i < views.size(); ++i) {
+            EXPECT_EQ(views[i].type, owning[i].type) << line;
+            EXPECT_EQ(expanded(views[i], ctx), owning[i].value) << line;
+        }
+        arena.release();
+    }
+}
+
+TEST(LexerTest, ViewsPointIntoInputUnlessRewritten) {
+    Lexer lexer;
+    LineArena arena;
+    const std::string line = "echo \"quoted text\" $VAR a'b'";
+    auto views = lexer.tokenize_views(line, arena);
+    ASSERT_EQ(views.size(), 5U);
+    auto inside = [&line](std::string_view v) {
+        return v.data() >= line.data() &&
+               v.data() + v.size() <= line.data() + line.size();
+    };
+    EXPECT_TRUE(inside(views[0].value));
+    EXPECT_EQ(views[1].value, "quoted text");
+    EXPECT_TRUE(inside(views[1].value));
+    EXPECT_EQ(views[2].value, "");
+    ASSERT_EQ(views[2].expansions.size(), 1U);
+    EXPECT_EQ(views[2].expansions[0].text, "VAR");
+    EXPECT_TRUE(inside(views[2].expansions[0].text));
+    EXPECT_EQ(views[3].value, "ab");
+    EXPECT_FALSE(inside(views[3].value));
+}
+
+TEST(LexerTest, ViewsUnclosedQuote) {
+    Lexer lexer;
+    LineArena arena;
+    EXPECT_THROW(lexer.tokenize_views("echo 'open", arena), std::runtime_error);
+}
+
+TEST(LexerTest, ScanPlainMatchesScalar) {
+    std::string input(200, 'a');
+    for (char special :
+         {'\\', '\'', '"', '$', '|', '=', '<', '>', '&', ';', ' ', '\t',
+          '\r', '\0'}) {
+        for (std::size_t at : {0, 5, 15, 16, 17, 63, 199}) {
+            std::string line = input;
+            line[at] = special;
+            for (std::size_t pos : {0, 3, 16, 100}) {
+                EXPECT_EQ(scan_plain(line, pos), scan_plain_scalar(line, pos));
+                EXPECT_EQ(scan_plain(line, pos), pos <= at ? at : line.size());
+            }
+        }
+    }
+    // Байты вне ASCII и соседние со спецсимволами коды — простые.
+    const std::string plain = "\x80\xff\x08\x0e\x1f!#%*+-?@[]^`{}~";
+    EXPECT_EQ(scan_plain(plain + plain, 0), 2 * plain.size());
+}
+
+TEST(LexerTest, LongPlainRuns) {
+    ExecutionContext ctx;
+    ctx.set_env("V", "x");
+    Lexer lexer;
+    const std::string long_word(100, 'w');
+    const std::string line =
+        "cmd " + long_word + " \"" + long_word + " $V\" " + long_word + "=1";
+    auto tokens = lexer.tokenize(line, ctx);
+    ASSERT_EQ(tokens.size(), 7U);
+    EXPECT_EQ(tokens[1].value, long_word);
+    EXPECT_EQ(tokens[2].value, long_word + " x");
+    EXPECT_EQ(tokens[3].value, long_word);
+    EXPECT_EQ(tokens[4].type, TokenType::OP_ASSIGN);
+    EXPECT_EQ(tokens[5].value, "1");
+}
+
 }  // namespace
 }  // namespace fluffy_tribble
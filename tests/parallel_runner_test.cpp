@@ -0,0 +1,195 @@
+#include "parallel_runner.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "command_manager.hpp"
+#include "command_parser.hpp"
+#include "execution_context.hpp"
+#include "lexer.hpp"
+#include "pipe_executor.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+std::string numbered_lines(int count) {
+    std::string lines;
+    for (int i = 0; i < count; ++i) {
+        lines += std::to_string(i) + '\n';
+    }
+    return lines;
+}
+
+TEST(ParallelRunnerTest, KeepOrderMatchesInput) {
+    ExecutionContext ctx;
+    std::istringstream in(numbered_lines(200));
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = 4, .keep_order = true, .command = {"echo", "n={}"}
+    };
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 0);
+
+    std::string expected;
+    for (int i = 0; i < 200; ++i) {
+        expected += "n=" + std::to_string(i) + '\n';
+    }
+    EXPECT_EQ(out.str(), expected);
+    EXPECT_EQ(err.str(), "");
+}
+
+TEST(ParallelRunnerTest, UnorderedOutputKeepsEveryResultWhole) {
+    ExecutionContext ctx;
+    std::istringstream in(numbered_lines(100) + "\n\n");
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = 3, .command = {"printf", "%s-%s\\n", "{}", "{}"}
+    };
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 0);
+
+    std::vector<std::string> lines;
+    std::istringstream result(out.str());
+    for (std::string line; std::getline(result, line);) {
+        lines.push_back(line);
+    }
+    std::vector<std::string> expected;
+    for (int i = 0; i < 100; ++i) {
+        expected.push_back(std::to_string(i) + '-' + std::to_string(i));
+    }
+    std::ranges::sort(lines);
+    std::ranges::sort(expected);
+    EXPECT_EQ(lines, expected);
+}
+
+TEST(ParallelRunnerTest, StatusCountsFailedCommands) {
+    ExecutionContext ctx;
+    std::istringstream in("0\n3\n0\n1\n");
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = 2, .command = {"sh", "-c", "exit {}"}
+    };
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 2);
+}
+
+TEST(ParallelRunnerTest, StatusCountsFailedBuiltins) {
+    ExecutionContext ctx;
+    std::istringstream in("/nonexistent/a\n/nonexistent/b\n/dev/null\n");
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{.jobs = 2, .command = {"cat"}};
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 2);
+    EXPECT_EQ(out.str(), "");
+}
+
+// Огромное -j не создаёт исполнителей больше, чем строк и kMaxJobs.
+TEST(ParallelRunnerTest, HugeJobCountIsBounded) {
+    ExecutionContext ctx;
+    std::istringstream in(numbered_lines(3));
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = std::size_t{1} << 60, .keep_order = true, .command = {"echo"}
+    };
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 0);
+    EXPECT_EQ(out.str(), numbered_lines(3));
+}
+
+TEST(ParallelRunnerTest, BuiltinsRunConcurrently) {
+    constexpr std::ptrdiff_t kWorkers = 4;
+    std::mutex mutex;
+    std::condition_variable all_arrived;
+    int arrived = 0;
+    // Команда ждёт, пока все kWorkers копий не начнутся одновременно.
+    CommandManager::register_builtin(
+        "parallel_test_meet",
+        [&](const std::vector<std::string> &,
+            std::istream &,
+            std::ostream &out,
+            std::ostream &,
+            ExecutionContext &) {
+            std::unique_lock lock(mutex);
+            ++arrived;
+            all_arrived.notify_all();
+            const bool met = all_arrived.wait_for(
+                lock,
+                std::chrono::seconds(10),
+                [&arrived] { return arrived >= kWorkers; }
+            );
+            out << (met ? "met\n" : "alone\n");
+            return met ? 0 : 1;
+        }
+    );
+    ExecutionContext ctx;
+    std::istringstream in(numbered_lines(kWorkers));
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = kWorkers, .command = {"parallel_test_meet"}
+    };
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 0);
+    EXPECT_EQ(out.str(), "met\nmet\nmet\nmet\n");
+}
+
+TEST(ParallelRunnerTest, LargeOutputSpillsInOrder) {
+    const std::string path = testing::TempDir() + "parallel_large.txt";
+    const std::string block(3 * ParallelRunner::kJobMemory, 'x');
+    {
+        std::ofstream file(path);
+        file << block;
+    }
+    ExecutionContext ctx;
+    ctx.set_env("TMPDIR", testing::TempDir());
+    std::istringstream in("A\nB\nC\n");
+    std::ostringstream out;
+    std::ostringstream err;
+    ParallelRunner::Options options{
+        .jobs = 3,
+        .keep_order = true,
+        .command = {"cat", path},
+        .window = 3,
+    };
+    // cat читает только первый аргумент: строка входа игнорируется.
+    EXPECT_EQ(ParallelRunner::run(options, in, out, err, ctx), 0);
+    EXPECT_EQ(out.str().size(), 3 * block.size());
+    EXPECT_EQ(err.str(), "");
+    std::remove(path.c_str());
+}
+
+TEST(ParallelRunnerTest, BuiltinFromPipeline) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    for (const char *line :
+         {"printf 'a\\nb\\nc\\n' | parallel -k -j 2 echo item",
+          "parallel -j", "parallel -j x echo", "parallel -j 0 echo",
+          "parallel exit"}) {
+        PipeExecutor::execute(
+            parser.parse(lexer.tokenize(line, ctx)), in, out, err, ctx
+        );
+    }
+    EXPECT_EQ(out.str(), "item a\nitem b\nitem c\n");
+    EXPECT_EQ(
+        err.str(),
+        "parallel: usage: parallel [-j N] [-k] COMMAND [ARG...]\n"
+        "parallel: x: invalid number of jobs\n"
+        "parallel: 0: invalid number of jobs\n"
+        "parallel: exit: cannot run in parallel\n"
+    );
+    EXPECT_EQ(ctx.last_status(), 2);
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
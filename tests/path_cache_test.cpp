@@ -0,0 +1,91 @@
+#include "path_cache.hpp"
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+namespace fs = std::filesystem;
+
+class PathCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = fs::temp_directory_path() /
+                ("ft_path_cache_" + std::to_string(getpid()));
+        fs::create_directories(root_ / "a");
+        fs::create_directories(root_ / "b");
+        path_env_ = (root_ / "a").string() + ":" + (root_ / "b").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(root_);
+    }
+
+    std::string make_program(const std::string &dir, const std::string &name) {
+        fs::path p = root_ / dir / name;
+        std::ofstream(p) << "#!/bin/sh\n";
+        fs::permissions(p, fs::perms::owner_all);
+        return p.string();
+    }
+
+    fs::path root_;
+    std::string path_env_;
+};
+
+TEST_F(PathCacheTest, ResolveCountsHits) {
+    PathCache cache;
+    std::string prog = make_program("b", "tool");
+    EXPECT_EQ(cache.resolve("tool", path_env_), prog);
+    EXPECT_EQ(cache.resolve("tool", path_env_), prog);
+    auto entries = cache.entries();
+    ASSERT_EQ(entries.size(), 1U);
+    EXPECT_EQ(entries[0].name, "tool");
+    EXPECT_EQ(entries[0].hits, 2U);
+}
+
+TEST_F(PathCacheTest, RememberDoesNotCountHits) {
+    PathCache cache;
+    make_program("a", "tool");
+    EXPECT_TRUE(cache.remember("tool", path_env_));
+    EXPECT_FALSE(cache.remember("missing_tool", path_env_));
+    auto entries = cache.entries();
+    ASSERT_EQ(entries.size(), 1U);
+    EXPECT_EQ(entries[0].hits, 0U);
+}
+
+TEST_F(PathCacheTest, ShadowingInEarlierDirInvalidates) {
+    PathCache cache;
+    std::string late = make_program("b", "tool");
+    EXPECT_EQ(cache.resolve("tool", path_env_), late);
+    // Force a visible mtime change even on coarse-grained filesystems
+    std::string early = make_program("a", "tool");
+    fs::last_write_time(
+        root_ / "a", fs::last_write_time(root_ / "a") + std::chrono::seconds(5)
+    );
+    EXPECT_EQ(cache.resolve("tool", path_env_), early);
+}
+
+TEST_F(PathCacheTest, NotFoundReturnsName) {
+    PathCache cache;
+    EXPECT_EQ(cache.resolve("missing_tool", path_env_), "missing_tool");
+    EXPECT_EQ(cache.resolve("./local", path_env_), "./local");
+    EXPECT_TRUE(cache.entries().empty());
+}
+
+TEST_F(PathCacheTest, SetEnvPathClearsCache) {
+    ExecutionContext ctx;
+    ctx.set_env("PATH", path_env_);
+    make_program("a", "tool");
+    EXPECT_TRUE(ctx.path_cache().remember("tool", path_env_));
+    ctx.set_env("PATH", path_env_);
+    EXPECT_EQ(ctx.path_cache().entries().size(), 1U);
+    ctx.set_env("PATH", (root_ / "b").string());
+    EXPECT_TRUE(ctx.path_cache().entries().empty());
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,56 @@
+#include "pipe_cache.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace fluffy_tribble {
+namespace {
+
+CommandList echo_pipe(const std::string &arg) {
+    return {ListItem{
+        .pipe = {ParsedCommand{
+            .name = "echo",
+            .args = {arg},
+            .id = CommandID::ECHO,
+            .redirects = {},
+            .words = {},
+        }}
+    }};
+}
+
+TEST(PipeCacheTest, HitReturnsStoredPipe) {
+    PipeCache cache;
+    EXPECT_EQ(cache.find("echo a"), nullptr);
+    auto stored = cache.insert("echo a", echo_pipe("a"));
+    auto found = cache.find("echo a");
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found, stored);
+    EXPECT_EQ(
+        found->front().pipe.front().args, std::vector<std::string>{"a"}
+    );
+    EXPECT_EQ(cache.find("echo b"), nullptr);
+}
+
+TEST(PipeCacheTest, EvictsLeastRecentlyUsed) {
+    PipeCache cache(2);
+    cache.insert("echo a", echo_pipe("a"));
+    cache.insert("echo b", echo_pipe("b"));
+    EXPECT_NE(cache.find("echo a"), nullptr);
+    cache.insert("echo c", echo_pipe("c"));
+    EXPECT_EQ(cache.size(), 2U);
+    EXPECT_NE(cache.find("echo a"), nullptr);
+    EXPECT_EQ(cache.find("echo b"), nullptr);
+    EXPECT_NE(cache.find("echo c"), nullptr);
+
+    cache.insert("echo c", echo_pipe("C"));
+    EXPECT_EQ(cache.size(), 2U);
+    EXPECT_EQ(
+        cache.find("echo c")->front().pipe.front().args.front(), "C"
+    );
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0U);
+    EXPECT_EQ(cache.find("echo a"), nullptr);
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
 #include <sstream>
+#include <string>
+#include <vector>
 #include "command_parser.hpp"
 #include "execution_context.hpp"
 #include "lexer.hpp"
 #include "pipe_executor.hpp"
+#include "stage_stats.hpp"
 
 namespace fluffy_tribble {
 namespace {
@@ -206,5 +211,271 @@ TEST(PipeTest, AssignmentInPipe) {
     EXPECT_EQ(ctx.env().at("VAR"), "newvalue");
 }
 
+TEST(PipeTest, StreamingMatchesSequential) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::string data;
+    for (int i = 0; i < 20000; ++i) {
+        data += "word" + std::to_string(i) + " another\n";
+    }
+
+    auto pipe = parser.parse(lexer.tokenize("cat | cat | wc", ctx));
+    ASSERT_EQ(pipe.size(), 3U);
+
+    std::istringstream in1(data);
+    std::ostringstream out1;
+    std::ostringstream err1;
+    PipeExecutor::execute(pipe, in1, out1, err1, ctx, PipeMode::SEQUENTIAL);
+
+    std::istringstream in2(data);
+    std::ostringstream out2;
+    std::ostringstream err2;
+    PipeExecutor::execute(pipe, in2, out2, err2, ctx, PipeMode::STREAMING);
+
+    EXPECT_EQ(out1.str(), "20000 40000 " + std::to_string(data.size()) + "\n");
+    EXPECT_EQ(out2.str(), out1.str());
+}
+
+TEST(PipeTest, StreamingStageIgnoringInput) {
+    // A stage that never reads its input must not block the producer
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in(std::string(1 << 20, 'x'));
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(lexer.tokenize("cat | echo done | cat", ctx));
+    PipeExecutor::execute(pipe, in, out, err, ctx, PipeMode::STREAMING);
+    EXPECT_EQ(out.str(), "done\n");
+}
+
+TEST(PipeTest, SequentialModeFromEnv) {
+    ExecutionContext ctx;
+    ctx.set_env(PipeExecutor::kModeEnv, "sequential");
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(lexer.tokenize("echo a b | wc", ctx));
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "1 2 4\n");
+}
+
+TEST(PipeTest, SequentialSpillsLargeOutput) {
+    const std::string path = testing::TempDir() + "pipe_spill.txt";
+    {
+        std::ofstream file(path);
+        for (int i = 0; i < 200000; ++i) {
+            file << "line " << i << '\n';
+        }
+    }
+    ExecutionContext ctx;
+    ctx.set_env(PipeExecutor::kModeEnv, "sequential");
+    ctx.set_env(PipeExecutor::kBufferEnv, "0");
+    ctx.set_env("TMPDIR", testing::TempDir());
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(
+        lexer.tokenize("cat " + path + " | cat | /usr/bin/tr e E | wc", ctx)
+    );
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "200000 400000 2288890\n");
+    EXPECT_EQ(err.str(), "");
+    std::remove(path.c_str());
+}
+
+TEST(PipeTest, ExternalChainConnectedDirectly) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(
+        lexer.tokenize("printf 'b\\na\\nc\\n' | sort | tr a-z A-Z", ctx)
+    );
+    ASSERT_EQ(pipe.size(), 3U);
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "A\nB\nC\n");
+    EXPECT_EQ(ctx.last_status(), 0);
+}
+
+TEST(PipeTest, ExternalChainBetweenBuiltins) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(
+        lexer.tokenize("echo one two | tr ' ' '\\n' | sort | wc", ctx)
+    );
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "2 2 8\n");
+}
+
+TEST(PipeTest, ErrorMissingProgramInChain) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(
+        lexer.tokenize("printf x | unknown_cmd_xyz | tr x y", ctx)
+    );
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "");
+    EXPECT_NE(err.str().find("unknown_cmd_xyz"), std::string::npos);
+    EXPECT_EQ(ctx.last_status(), 0);
+}
+
+std::string read_file(const std::string &path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST(PipeTest, RedirectBuiltinOutputAndInput) {
+    const std::string path = testing::TempDir() + "pipe_redirect.txt";
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    for (const std::string &line :
+         {"echo one > " + path, "echo two three >> " + path,
+          "wc < " + path + " | cat", "/bin/cat < " + path + " | wc"}) {
+        PipeExecutor::execute(
+            parser.parse(lexer.tokenize(line, ctx)), in, out, err, ctx
+        );
+    }
+    EXPECT_EQ(read_file(path), "one\ntwo three\n");
+    EXPECT_EQ(out.str(), "2 3 14\n2 3 14\n");
+    EXPECT_EQ(err.str(), "");
+    std::remove(path.c_str());
+}
+
+TEST(PipeTest, RedirectExternalChainToFiles) {
+    const std::string src = testing::TempDir() + "pipe_redirect_src.txt";
+    const std::string dst = testing::TempDir() + "pipe_redirect_dst.txt";
+    const std::string log = testing::TempDir() + "pipe_redirect_err.txt";
+    {
+        std::ofstream file(src);
+        file << "b\na\nc\n";
+    }
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(lexer.tokenize(
+        "sort < " + src + " | tr a-z A-Z > " + dst + " | cat", ctx
+    ));
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(read_file(dst), "A\nB\nC\n");
+    EXPECT_EQ(out.str(), "");
+
+    pipe = parser.parse(
+        lexer.tokenize("unknown_cmd_xyz 2> " + log + " > " + dst, ctx)
+    );
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(err.str(), "");
+    EXPECT_NE(read_file(log).find("unknown_cmd_xyz"), std::string::npos);
+    EXPECT_EQ(read_file(dst), "");
+    EXPECT_EQ(ctx.last_status(), 127);
+
+    for (const std::string &path : {src, dst, log}) {
+        std::remove(path.c_str());
+    }
+}
+
+TEST(PipeTest, RedirectMissingInputFile) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    for (const char *line :
+         {"wc < /nonexistent/in", "/bin/cat < /nonexistent/in"}) {
+        PipeExecutor::execute(
+            parser.parse(lexer.tokenize(line, ctx)), in, out, err, ctx
+        );
+        EXPECT_EQ(ctx.last_status(), 1) << line;
+    }
+    EXPECT_EQ(out.str(), "");
+    EXPECT_EQ(
+        err.str(),
+        "fluffy-tribble: /nonexistent/in: No such file or directory\n"
+        "fluffy-tribble: /nonexistent/in: No such file or directory\n"
+    );
+}
+
+TEST(PipeTest, TimePrefixReportsStages) {
+    ExecutionContext ctx;
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(
+        lexer.tokenize("time echo one two | tr a-z A-Z | wc", ctx)
+    );
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "1 2 8\n");
+    const std::string report = err.str();
+    EXPECT_NE(report.find("0 in  8 out  echo one two\n"), std::string::npos);
+    EXPECT_NE(report.find("8 in  8 out  tr a-z A-Z\n"), std::string::npos);
+    EXPECT_NE(report.find("8 in  6 out  wc\n"), std::string::npos);
+    EXPECT_NE(report.find("\nreal\t"), std::string::npos);
+}
+
+TEST(PipeTest, TraceWritesRecordPerStage) {
+    ExecutionContext ctx;
+    const std::string path = testing::TempDir() + "pipe_trace.jsonl";
+    std::remove(path.c_str());
+    ctx.set_env(kTraceEnv, path);
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+
+    auto pipe = parser.parse(lexer.tokenize("echo \"a b\" | sort | cat", ctx));
+    PipeExecutor::execute(pipe, in, out, err, ctx);
+    EXPECT_EQ(out.str(), "a b\n");
+    EXPECT_EQ(err.str(), "");
+
+    std::ifstream trace(path);
+    std::vector<std::string> records;
+    for (std::string line; std::getline(trace, line);) {
+        records.push_back(line);
+    }
+    ASSERT_EQ(records.size(), 3U);
+    EXPECT_EQ(records[0].find("{\"stage\":0,\"command\":\"echo a b\""), 0U);
+    EXPECT_NE(records[1].find("\"command\":\"sort\""), std::string::npos);
+    EXPECT_NE(records[2].find("\"bytes_in\":4,"), std::string::npos);
+    std::remove(path.c_str());
+}
+
 }  // namespace
 }  // namespace fluffy_tribble
\ No newline at end of file
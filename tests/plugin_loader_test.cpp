@@ -0,0 +1,153 @@
+#include "plugin_loader.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "command_manager.hpp"
+#include "command_parser.hpp"
+#include "execution_context.hpp"
+#include "interpreter.hpp"
+#include "lexer.hpp"
+#include "pipe_executor.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+std::string run_line(
+    const std::string &line,
+    ExecutionContext &ctx,
+    std::string *err_out = nullptr
+) {
+    Lexer lexer;
+    CommandParser parser;
+    std::istringstream in;
+    std::ostringstream out;
+    std::ostringstream err;
+    PipeExecutor::execute(
+        parser.parse(lexer.tokenize(line, ctx)), in, out, err, ctx
+    );
+    if (err_out) {
+        *err_out = err.str();
+    }
+    return out.str();
+}
+
+TEST(PluginLoaderTest, CallableRunsInPipeline) {
+    CommandManager::register_builtin(
+        "upcase_test",
+        [](const std::vector<std::string> &args,
+           std::istream &input,
+           std::ostream &output,
+           std::ostream &,
+           ExecutionContext &) {
+            for (std::string line; std::getline(input, line);) {
+                for (char &c : line) {
+                    c = static_cast<char>(std::toupper(c));
+                }
+                output << line << args.size() << '\n';
+            }
+            return 4;
+        }
+    );
+    EXPECT_EQ(
+        CommandManager::get_command_id("upcase_test"), CommandID::PLUGIN
+    );
+
+    ExecutionContext ctx;
+    EXPECT_EQ(run_line("echo abc | upcase_test x | cat", ctx), "ABC1\n");
+    EXPECT_EQ(run_line("echo abc | upcase_test", ctx), "ABC0\n");
+    EXPECT_EQ(ctx.last_status(), 4);
+}
+
+TEST(PluginLoaderTest, ReRegisterReplacesImplementation) {
+    const auto constant = [](int value) {
+        return [value](
+                   const std::vector<std::string> &,
+                   std::istream &,
+                   std::ostream &output,
+                   std::ostream &,
+                   ExecutionContext &
+               ) {
+            output << value << '\n';
+            return 0;
+        };
+    };
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    CommandManager::register_builtin("const_test", constant(1));
+    interpreter.execute_line("const_test");
+    CommandManager::register_builtin("const_test", constant(2));
+    interpreter.execute_line("const_test");
+    EXPECT_EQ(out.str(), "1\n2\n");
+}
+
+TEST(PluginLoaderTest, RegistrationInvalidatesCachedLines) {
+    ExecutionContext ctx;
+    std::istringstream in;
+    std::ostringstream out, err;
+    Interpreter interpreter(ctx, in, out, err);
+    interpreter.execute_line("late_test_cmd_xyz");
+    EXPECT_NE(err.str().find("command not found"), std::string::npos);
+    CommandManager::register_builtin(
+        "late_test_cmd_xyz",
+        [](const std::vector<std::string> &,
+           std::istream &,
+           std::ostream &output,
+           std::ostream &,
+           ExecutionContext &) {
+            output << "late\n";
+            return 0;
+        }
+    );
+    interpreter.execute_line("late_test_cmd_xyz");
+    EXPECT_EQ(out.str(), "late\n");
+}
+
+TEST(PluginLoaderTest, EnableLoadsSharedObject) {
+    ExecutionContext ctx;
+    std::string err;
+    const std::string plugin = FLUFFY_TRIBBLE_TEST_PLUGIN;
+    EXPECT_EQ(run_line("enable -f " + plugin + " rev argc", ctx, &err), "");
+    EXPECT_EQ(err, "");
+    EXPECT_EQ(CommandManager::get_command_id("rev"), CommandID::PLUGIN);
+
+    EXPECT_EQ(
+        run_line("echo hello world | rev | /bin/cat", ctx), "dlrow olleh\n"
+    );
+    EXPECT_EQ(ctx.last_status(), 0);
+
+    ctx.set_env("PLUGIN_VAR", "v");
+    EXPECT_EQ(run_line("argc a b", ctx, &err), "argc 3 v\n");
+    EXPECT_EQ(err, "done\n");
+    EXPECT_EQ(ctx.last_status(), 3);
+}
+
+TEST(PluginLoaderTest, ErrorEnable) {
+    ExecutionContext ctx;
+    std::string err;
+    run_line("enable rev", ctx, &err);
+    EXPECT_EQ(err, "enable: usage: enable -f FILE NAME...\n");
+    EXPECT_EQ(ctx.last_status(), 2);
+
+    run_line("enable -f /nonexistent/lib.so rev", ctx, &err);
+    EXPECT_EQ(ctx.last_status(), 1);
+    EXPECT_EQ(
+        err.find("enable: cannot open shared object /nonexistent/lib.so: "), 0U
+    );
+
+    run_line(
+        std::string("enable -f ") + FLUFFY_TRIBBLE_TEST_PLUGIN + " missing",
+        ctx,
+        &err
+    );
+    EXPECT_EQ(
+        err.find("enable: missing: fluffy_tribble_builtin_missing not found"),
+        0U
+    );
+    EXPECT_EQ(CommandManager::get_command_id("missing"), CommandID::EXTERNAL);
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,118 @@
+#include "spill_buffer.hpp"
+#include <gtest/gtest.h>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include "execution_context.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+std::string pattern(std::size_t size) {
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+    return data;
+}
+
+std::string read_all(SpillBuffer &buffer) {
+    std::istream in(&buffer);
+    return std::string(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()
+    );
+}
+
+TEST(SpillBufferTest, SmallDataStaysInMemory) {
+    SpillBuffer buffer(1024, testing::TempDir());
+    std::ostream out(&buffer);
+    out << "hello " << 42 << '\n';
+    out.flush();
+    EXPECT_EQ(buffer.size(), 9U);
+    buffer.rewind();
+    EXPECT_FALSE(buffer.spilled());
+    EXPECT_EQ(read_all(buffer), "hello 42\n");
+}
+
+TEST(SpillBufferTest, SpillsPastMemoryLimit) {
+    const std::string data = pattern(3 * SpillBuffer::kFileBlock + 123);
+    SpillBuffer buffer(1000, testing::TempDir());
+    std::ostream out(&buffer);
+    // Вперемешку посимвольная запись, мелкие и крупные блоки.
+    out.put(data[0]);
+    out.write(data.data() + 1, 99);
+    out.write(data.data() + 100, 2 * SpillBuffer::kFileBlock);
+    for (std::size_t i = 100 + 2 * SpillBuffer::kFileBlock; i < data.size();
+         ++i) {
+        out.put(data[i]);
+    }
+    out.flush();
+    EXPECT_TRUE(out.good());
+    EXPECT_TRUE(buffer.spilled());
+    EXPECT_FALSE(buffer.failed());
+    EXPECT_EQ(buffer.size(), data.size());
+
+    buffer.rewind();
+    std::istream in(&buffer);
+    char head[10];
+    in.read(head, sizeof(head));
+    EXPECT_EQ(std::string(head, sizeof(head)), data.substr(0, 10));
+    EXPECT_GT(in.rdbuf()->in_avail(), 0);
+    std::string rest(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>{}
+    );
+    EXPECT_EQ(rest, data.substr(10));
+}
+
+TEST(SpillBufferTest, ZeroLimitWritesEverythingToFile) {
+    SpillBuffer buffer(0, testing::TempDir());
+    std::ostream out(&buffer);
+    out << "abc";
+    out.flush();
+    EXPECT_TRUE(buffer.spilled());
+    buffer.rewind();
+    EXPECT_EQ(read_all(buffer), "abc");
+}
+
+TEST(SpillBufferTest, ResetReusesBuffer) {
+    SpillBuffer buffer(16, testing::TempDir());
+    std::ostream out(&buffer);
+    out << pattern(100);
+    out.flush();
+    buffer.rewind();
+    EXPECT_EQ(read_all(buffer), pattern(100));
+
+    buffer.reset();
+    EXPECT_EQ(buffer.size(), 0U);
+    EXPECT_FALSE(buffer.spilled());
+    out.clear();
+    out << "second";
+    out.flush();
+    buffer.rewind();
+    EXPECT_EQ(read_all(buffer), "second");
+}
+
+TEST(SpillBufferTest, ErrorMissingTempDir) {
+    SpillBuffer buffer(4, "/nonexistent/fluffy-tribble-dir");
+    std::ostream out(&buffer);
+    out << "abcdefgh";
+    out.flush();
+    EXPECT_FALSE(out.good());
+    EXPECT_TRUE(buffer.failed());
+    buffer.rewind();
+    EXPECT_EQ(read_all(buffer), "abcd");
+}
+
+TEST(SpillBufferTest, TempDirFromEnvironment) {
+    ExecutionContext ctx;
+    ctx.unset_env("TMPDIR");
+    EXPECT_EQ(SpillBuffer::temp_dir(ctx), "/tmp");
+    ctx.set_env("TMPDIR", "");
+    EXPECT_EQ(SpillBuffer::temp_dir(ctx), "/tmp");
+    ctx.set_env("TMPDIR", "/var/tmp");
+    EXPECT_EQ(SpillBuffer::temp_dir(ctx), "/var/tmp");
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "stage_stats.hpp"
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "command_executor.hpp"
+#include "execution_context.hpp"
+#include "fd_stream.hpp"
+
+namespace fluffy_tribble {
+namespace {
+
+TEST(StageStatsTest, CountingBufferCountsBothDirections) {
+    std::istringstream source("line one\nline two\n");
+    CountingStreamBuf in_buf(source.rdbuf());
+    std::istream in(&in_buf);
+    std::string line;
+    std::getline(in, line);
+    EXPECT_EQ(line, "line one");
+    EXPECT_EQ(in_buf.count(), 9U);
+
+    std::ostringstream sink;
+    CountingStreamBuf out_buf(sink.rdbuf());
+    std::ostream out(&out_buf);
+    out << 'x' << "yz" << 42;
+    out.flush();
+    EXPECT_EQ(sink.str(), "xyz42");
+    EXPECT_EQ(out_buf.count(), 5U);
+}
+
+TEST(StageStatsTest, DescribeCommands) {
+    ParsedCommand echo{
+        .name = "echo",
+        .args = {"a", "b"},
+        .id = CommandID::ECHO,
+        .redirects = {},
+        .words = {},
+    };
+    ParsedCommand sort{
+        .name = "sort",
+        .args = {"sort", "-r"},
+        .id = CommandID::EXTERNAL,
+        .redirects = {},
+        .words = {},
+    };
+    ParsedCommand cmds[] = {echo, sort};
+    EXPECT_EQ(describe_commands(cmds), "echo a b | sort -r");
+}
+
+TEST(StageStatsTest, ExternalCommandCpuAndBytes) {
+    ExecutionContext ctx;
+    ParsedCommand cmd{
+        .name = "sh",
+        .args = {"sh", "-c", "i=0; while [ $i -lt 20000 ]; do i=$((i+1)); "
+                             "done; cat"},
+        .id = CommandID::EXTERNAL,
+        .redirects = {},
+        .words = {},
+    };
+    std::istringstream in("payload");
+    std::ostringstream out, err;
+    StageStats stats;
+    int status = CommandExecutor::run(cmd, in, out, err, ctx, &stats);
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(out.str(), "payload");
+    EXPECT_EQ(stats.status, 0);
+    EXPECT_EQ(stats.bytes_in, 7U);
+    EXPECT_EQ(stats.bytes_out, 7U);
+    EXPECT_GT(stats.user_seconds + stats.sys_seconds, 0.0);
+    EXPECT_GE(stats.wall_seconds, 0.0);
+}
+
+TEST(StageStatsTest, TimeKeepsOutputDescriptor) {
+    // Программа под time пишет в сам файл, а не в канал ретрансляции.
+    ExecutionContext ctx;
+    const std::string path = testing::TempDir() + "stage_stats_fd_out.txt";
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_NE(fd, -1);
+    ParsedCommand cmd{
+        .name = "time",
+        .args = {"sh", "-c", "[ -f /dev/stdout ] && echo file"},
+        .id = CommandID::TIME,
+        .redirects = {},
+        .words = {},
+    };
+    std::istringstream in;
+    std::ostringstream err;
+    {
+        FdStreamBuf buf(fd);
+        std::ostream out(&buf);
+        out << "head\n";
+        EXPECT_EQ(CommandExecutor::run(cmd, in, out, err, ctx), 0);
+    }
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), "head\nfile\n");
+    EXPECT_NE(err.str().find("  0 in  5 out  sh -c"), std::string::npos)
+        << err.str();
+    std::remove(path.c_str());
+}
+
+TEST(StageStatsTest, TimeBuiltinWithoutCommand) {
+    ExecutionContext ctx;
+    ParsedCommand cmd{
+        .name = "time",
+        .args = {},
+        .id = CommandID::TIME,
+        .redirects = {},
+        .words = {},
+    };
+    std::istringstream in;
+    std::ostringstream out, err;
+    EXPECT_EQ(CommandExecutor::run(cmd, in, out, err, ctx), 0);
+    EXPECT_EQ(out.str(), "");
+    EXPECT_EQ(err.str(), "\nreal\t0.000s\nuser\t0.000s\nsys\t0.000s\n");
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
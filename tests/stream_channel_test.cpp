@@ -0,0 +1,55 @@
+#include "stream_channel.hpp"
+#include <gtest/gtest.h>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace fluffy_tribble {
+namespace {
+
+TEST(StreamChannelTest, ReadAfterWrite) {
+    StreamChannel channel(16);
+    ASSERT_TRUE(channel.write("hello", 5));
+    channel.close_write();
+    char buf[16];
+    ASSERT_EQ(channel.read(buf, sizeof(buf)), 5U);
+    EXPECT_EQ(std::string(buf, 5), "hello");
+    EXPECT_EQ(channel.read(buf, sizeof(buf)), 0U);
+}
+
+TEST(StreamChannelTest, BackpressureKeepsOrder) {
+    // Data much larger than capacity must pass through unchanged
+    StreamChannel channel(7);
+    std::string data;
+    for (int i = 0; i < 10000; ++i) {
+        data += std::to_string(i) + ',';
+    }
+    std::thread writer([&] {
+        ChannelWriteBuf buf(channel);
+        std::ostream out(&buf);
+        out << data;
+        out.flush();
+        channel.close_write();
+    });
+    ChannelReadBuf buf(channel);
+    std::istream in(&buf);
+    std::string received(std::istreambuf_iterator<char>(in), {});
+    writer.join();
+    EXPECT_EQ(received, data);
+}
+
+TEST(StreamChannelTest, CloseReadUnblocksWriter) {
+    StreamChannel channel(4);
+    std::thread writer([&] {
+        std::string big(1024, 'x');
+        EXPECT_FALSE(channel.write(big.data(), big.size()));
+    });
+    char buf[2];
+    EXPECT_EQ(channel.read(buf, sizeof(buf)), 2U);
+    channel.close_read();
+    writer.join();
+}
+
+}  // namespace
+}  // namespace fluffy_tribble
@@ -0,0 +1,49 @@
+#include <string>
+#include "plugin_api.h"
+
+// Команды для проверки enable -f: rev переворачивает строки входа, argc
+// выводит число аргументов и значение переменной PLUGIN_VAR.
+
+extern "C" int fluffy_tribble_builtin_rev(
+    int,
+    char *const *,
+    const fluffy_tribble_io *io
+) {
+    std::string data;
+    char buf[4096];
+    ptrdiff_t n;
+    while ((n = io->read(io->state, buf, sizeof(buf))) > 0) {
+        data.append(buf, static_cast<size_t>(n));
+    }
+    std::string out;
+    size_t begin = 0;
+    while (begin < data.size()) {
+        size_t end = data.find('\n', begin);
+        const bool newline = end != std::string::npos;
+        if (!newline) {
+            end = data.size();
+        }
+        out.append(
+            data.rbegin() + static_cast<long>(data.size() - end),
+            data.rbegin() + static_cast<long>(data.size() - begin)
+        );
+        if (newline) {
+            out += '\n';
+        }
+        begin = end + 1;
+    }
+    return io->write(io->state, 1, out.data(), out.size()) < 0 ? 1 : 0;
+}
+
+extern "C" int fluffy_tribble_builtin_argc(
+    int argc,
+    char *const *argv,
+    const fluffy_tribble_io *io
+) {
+    const char *var = io->getenv(io->state, "PLUGIN_VAR");
+    std::string out = std::string(argv[0]) + " " + std::to_string(argc) +
+                      " " + (var ? var : "(unset)") + "\n";
+    io->write(io->state, 1, out.data(), out.size());
+    io->write(io->state, 2, "done\n", 5);
+    return argc == 1 ? 0 : 3;
+}
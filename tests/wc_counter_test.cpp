@@ -0,0 +1,109 @@
+#include "wc_counter.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace fluffy_tribble {
+namespace {
+
+/** Прежняя построчная реализация wc — эталон для сравнения. */
+WcCounts reference_count(const std::string &data) {
+    WcCounts counts;
+    std::istringstream in(data);
+    std::string line;
+    while (std::getline(in, line)) {
+        ++counts.lines;
+        counts.bytes += line.size() + 1;
+        std::istringstream iss(line);
+        std::string w;
+        while (iss >> w) {
+            ++counts.words;
+        }
+    }
+    return counts;
+}
+
+void expect_same(const WcCounts &actual, const WcCounts &expected) {
+    EXPECT_EQ(actual.lines, expected.lines);
+    EXPECT_EQ(actual.words, expected.words);
+    EXPECT_EQ(actual.bytes, expected.bytes);
+}
+
+std::string random_text(std::size_t size, unsigned seed) {
+    static constexpr char kAlphabet[] = "ab \t\n\v\f\r\x80\xff";
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<std::size_t> pick(
+        0, sizeof(kAlphabet) - 2
+    );
+    std::string text(size, ' ');
+    for (char &c : text) {
+        c = kAlphabet[pick(gen)];
+    }
+    return text;
+}
+
+TEST(WcCounterTest, EmptyInput) {
+    expect_same(WcCounter::count(""), WcCounts{});
+}
+
+TEST(WcCounterTest, TrailingPartialLine) {
+    WcCounts counts = WcCounter::count("one two\nthree");
+    EXPECT_EQ(counts.lines, 2);
+    EXPECT_EQ(counts.words, 3);
+    EXPECT_EQ(counts.bytes, 14);
+}
+
+TEST(WcCounterTest, AllKernelsMatchReference) {
+    for (WcKernel kernel :
+         {WcKernel::SCALAR, WcKernel::SSE2, WcKernel::AVX2}) {
+        if (!WcCounter::kernel_supported(kernel)) {
+            continue;
+        }
+        for (std::size_t size : {1, 63, 64, 65, 1000, 100000}) {
+            const std::string text = random_text(size, size);
+            WcCounter counter(kernel);
+            counter.feed(text);
+            expect_same(counter.counts(), reference_count(text));
+        }
+    }
+}
+
+TEST(WcCounterTest, WordsSplitAcrossFeeds) {
+    const std::string text = random_text(10000, 7);
+    WcCounter counter;
+    // Куски разного размера: слова и строки разрезаются между вызовами.
+    std::size_t pos = 0;
+    for (std::size_t step = 1; pos < text.size(); step = step * 3 % 200 + 1) {
+        const std::size_t n = std::min(step, text.size() - pos);
+        counter.feed(text.data() + pos, n);
+        pos += n;
+    }
+    expect_same(counter.counts(), reference_count(text));
+}
+
+TEST(WcCounterTest, ParallelMatchesSequential) {
+    // Несколько частей по 8 МиБ; слова пересекают границы частей.
+    std::string text;
+    const std::string pattern = random_text(4099, 11);
+    while (text.size() < 40 * 1024 * 1024) {
+        text += pattern;
+    }
+    text += "tail";
+    for (std::size_t threads : {1, 2, 3, 8}) {
+        expect_same(
+            WcCounter::count_parallel(text, threads), WcCounter::count(text)
+        );
+    }
+}
+
+TEST(WcCounterTest, ParallelSplitsLongWord) {
+    const std::string text(32 * 1024 * 1024, 'w');
+    WcCounts counts = WcCounter::count_parallel(text, 4);
+    EXPECT_EQ(counts.words, 1);
+    EXPECT_EQ(counts.lines, 1);
+    EXPECT_EQ(counts.bytes, text.size() + 1);
+}
+
+}  // namespace
+}  // namespace fluffy_tribble